@@ -0,0 +1,72 @@
+#pragma once
+
+#include <ostream>
+#include <vector>
+#include "GameWorld.h"
+#include "InputScript.h"
+#include "ThreadPool.h"
+
+/// <summary>
+/// @brief What happened in one headless match
+/// </summary>
+struct MatchResult
+{
+	unsigned seed{ 0 };
+	GameWorld::Outcome outcome{ GameWorld::Outcome::InProgress };
+	unsigned ticks{ 0 };
+	float simTime{ 0.0f };
+	float score{ 0.0f };
+	int targetsCollected{ 0 };
+	std::vector<float> timePerTarget;
+
+	unsigned enemyShots{ 0 };
+	unsigned playerHitsTaken{ 0 };
+	unsigned enemyHitsTaken{ 0 };
+};
+
+/// <summary>
+/// @brief Plays many independent headless matches across a thread pool.
+/// 
+/// Each match gets its own GameWorld seeded with (first seed + match number), so a batch is
+/// reproducible whatever the thread count or the order the pool happens to run matches in.
+/// All matches share the level data and input script, which are only ever read, and step at
+/// the update rate the script was recorded at.
+/// </summary>
+class BatchRunner
+{
+public:
+	/// <param name="t_level">Level every match is played on</param>
+	/// <param name="t_script">Player input every match is driven by, may be empty; also sets the step length</param>
+	/// <param name="t_maxTicks">Matches still undecided after this many ticks are cut short</param>
+	BatchRunner(LevelData const& t_level, InputScript const& t_script, unsigned t_maxTicks);
+
+	/// <summary>
+	/// @brief Plays a batch of matches, blocking until they have all finished
+	/// </summary>
+	/// <param name="t_matchCount">Number of matches to play</param>
+	/// <param name="t_firstSeed">Seed of the first match, later matches count up from it</param>
+	/// <param name="t_pool">Pool to play the matches on</param>
+	/// <returns>One result per match, in seed order</returns>
+	std::vector<MatchResult> run(unsigned t_matchCount, unsigned t_firstSeed, ThreadPool& t_pool);
+
+	/// <summary>
+	/// @brief Plays one match on the calling thread
+	/// </summary>
+	MatchResult runMatch(unsigned t_seed) const;
+
+	/// <summary>
+	/// @brief Writes a summary of a batch: per-match lines followed by totals
+	/// </summary>
+	static void report(std::vector<MatchResult> const& t_results, std::ostream& t_out);
+
+private:
+	LevelData const& ref_level;
+	InputScript const& ref_script;
+	unsigned m_maxTicks;
+
+	// Fixed simulation step, matching the rate the script was recorded at (60Hz unless told otherwise)
+	sf::Time m_tick;
+
+	// Matches are never drawn, so they all share one empty sprite sheet
+	sf::Texture m_noTexture;
+};
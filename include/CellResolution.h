@@ -12,9 +12,30 @@ public:
 	/// @brief Find the grid position of a given point in 2D space
 	/// </summary>
 	/// <param name="t_pos">position of the object to check</param>
-	/// <returns>grid reference as vector2i, or -1 if object out of window bounds</returns>
+	/// <returns>grid reference in the range [0, getCellCount()), or -1 if object out of world bounds</returns>
 	static int getGridRef(sf::Vector2f t_pos);
 
+	/// <summary>
+	/// @brief Find the grid reference of a given column/row pair
+	/// </summary>
+	/// <param name="t_col">column of the cell</param>
+	/// <param name="t_row">row of the cell</param>
+	/// <returns>grid reference, or -1 if the cell is outside of the world</returns>
+	static int getGridRef(int t_col, int t_row);
+
+	/// <summary>
+	/// @brief Find the column/row of a given point, clamped to the edges of the world
+	/// </summary>
+	/// <param name="t_pos">position to check</param>
+	/// <returns>column (x) and row (y) of the cell containing the point</returns>
+	static sf::Vector2i getCellCoords(sf::Vector2f t_pos);
+
+	/// <summary>
+	/// @brief Returns the top-left position of a cell in world space
+	/// </summary>
+	/// <param name="t_gridRef">grid reference of the cell</param>
+	static sf::Vector2f getCellPosition(int t_gridRef);
+
 	/// <summary>
 	/// 
 	/// </summary>
@@ -28,8 +49,16 @@ public:
 	/// <returns></returns>
 	static sf::Vector2f temp_getCellSize() { return CELL_SIZE; }
 
+	// Number of cells across the whole (2x screen size) world
+	const static int WORLD_COLS{ 20 }, WORLD_ROWS{ 20 };
+
+	/// <summary>
+	/// @brief Total number of cells in the world grid
+	/// </summary>
+	static constexpr int getCellCount() { return WORLD_COLS * WORLD_ROWS; }
+
 private:
 
 	const static int NUM_ROWS{ 10 }, NUM_COLS{ 10 };
 	const static sf::Vector2f CELL_SIZE;
-};
\ No newline at end of file
+};
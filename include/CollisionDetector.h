@@ -2,6 +2,10 @@
 
 #include <SFML/Graphics.hpp>
 #include "OrientedBoundingBox.h"
+#include "GameObject.h"
+#include <vector>
+#include <cstdint>
+#include <atomic>
 
 /// <summary>
 /// @brief Collision detection class for bounding box collisions using the Separating Axis Theorem (SAT)
@@ -16,8 +20,100 @@
 /// </summary>
 
 
+class RayFan // Rays sharing one origin stored structure-of-arrays, for CollisionDetector's batched ray tests
+{
+public:
+	void Reset(sf::Vector2f Start, float Distance); // Remove all rays, move the origin and set how far they reach
+	void Add(sf::Vector2f Direction); // Append a ray, Direction must be unit length
+	std::size_t Size() const { return DirX.size(); }
+
+	sf::Vector2f Origin;
+	float MaxDistance{ 0.0f };
+	std::vector<float> DirX; // DirX[ray]
+	std::vector<float> DirY;
+	std::vector<float> Nearest; // Distance to the nearest hit so far along each ray, MaxDistance if none
+};
+
+
 class CollisionDetector
 {
 public:
+	/// <summary>
+	/// @brief Running totals of how many box pairs each stage of the OBB tests rejected
+	/// </summary>
+	struct Stats
+	{
+		std::atomic<unsigned long long> pairsTested{ 0 };
+		std::atomic<unsigned long long> circleRejected{ 0 };
+		std::atomic<unsigned long long> aabbRejected{ 0 };
+		std::atomic<unsigned long long> satRejected{ 0 };
+		std::atomic<unsigned long long> collisions{ 0 };
+	};
+
+	/// <summary>
+	/// @brief Get the rejection counters for OBB tests run on the calling thread.
+	/// Kept per thread so matches simulated side by side don't fight over one cache line.
+	/// </summary>
+	static Stats& getStats();
+
+	/// <summary>
+	/// @brief Zero the rejection counters
+	/// </summary>
+	static void resetStats();
+
+	/// <summary>
+	/// @brief Moves the calling thread's counters onto another thread's, zeroing ours.
+	/// Worker threads hand back their counts this way so they're seen where the counters are read
+	/// </summary>
+	/// <param name="t_total">Counters to add to, e.g. getStats() taken on the world's thread</param>
+	static void addStatsTo(Stats& t_total);
+
 	bool static collision(const sf::Sprite& object1, const sf::Sprite& object2);
+
+	/// <summary>
+	/// @brief Checks for a collision between two already calculated bounding boxes.
+	/// Their bounding circles and then AABBs are compared before falling back to SAT
+	/// </summary>
+	/// <param name="OBB1">first box, e.g. GameObject::getBoundingBox()</param>
+	/// <param name="OBB2">second box</param>
+	/// <returns>True if the boxes collide</returns>
+	bool static collision(const OrientedBoundingBox& OBB1, const OrientedBoundingBox& OBB2);
+
+	/// <summary>
+	/// @brief Checks one box against every box in a batch, four at a time with SSE where available.
+	/// Bounding circles and then AABBs are compared lane-wise first; groups that are all clear of ours skip SAT
+	/// </summary>
+	/// <param name="OBB">box to test</param>
+	/// <param name="batch">boxes to test against</param>
+	/// <param name="hitMask">bit (i % 32) of word (i / 32) is set if box i of the batch collides</param>
+	/// <returns>The number of boxes in the batch that collide</returns>
+	int static collision(const OrientedBoundingBox& OBB, const OrientedBoundingBoxBatch& batch, std::vector<std::uint32_t>& hitMask);
+
+	/// <summary>
+	/// @brief Tests a line segment (e.g. a projectile's movement over one tick) against an oriented box
+	/// </summary>
+	/// <param name="t_start">start of the segment</param>
+	/// <param name="t_end">end of the segment</param>
+	/// <param name="t_box">box to test against</param>
+	/// <param name="t_hitTime">set to the fraction along the segment [0,1] where it enters the box</param>
+	/// <returns>True if the segment touches the box</returns>
+	bool static segmentCollision(sf::Vector2f t_start, sf::Vector2f t_end, const OrientedBoundingBox& t_box, float& t_hitTime);
+
+	/// <summary>
+	/// @brief Tests a line segment against a batch of objects, without allocating
+	/// </summary>
+	/// <param name="t_start">start of the segment</param>
+	/// <param name="t_end">end of the segment</param>
+	/// <param name="t_candidates">objects to test against</param>
+	/// <param name="t_hitTime">set to the fraction along the segment [0,1] of the earliest hit</param>
+	/// <returns>Index of the first object the segment hits, or -1 if none</returns>
+	int static segmentCollision(sf::Vector2f t_start, sf::Vector2f t_end, const std::vector<GameObject*>& t_candidates, float& t_hitTime);
+
+	/// <summary>
+	/// @brief Casts every ray of a fan against an oriented box. The box's bounding circle is tested
+	/// four rays at a time with SSE where available, and only rays that reach it are clipped against the box
+	/// </summary>
+	/// <param name="t_fan">rays to cast; each ray's Nearest is lowered to where it enters the box, if that's nearer</param>
+	/// <param name="t_box">box to cast against, e.g. GameObject::getBoundingBox()</param>
+	void static rayFanBox(RayFan& t_fan, const OrientedBoundingBox& t_box);
 };
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <stdexcept>
+#include <memory>
+#include <utility>
+
+/// <summary>
+/// @brief Contiguous storage for objects that must never move once built.
+/// 
+/// Like a std::vector that can only grow up to the capacity it was given, so elements are
+/// constructed in place and never relocated. That suits types which are neither copyable nor
+/// movable and types that hand out pointers to themselves (anything registered in the
+/// SpatialGrid), while still iterating as a plain array.
+/// </summary>
+template <typename T>
+class FixedArray
+{
+public:
+	FixedArray() = default;
+
+	~FixedArray()
+	{
+		clear();
+		m_allocator.deallocate(m_data, m_capacity);
+	}
+
+	FixedArray(FixedArray const&) = delete;
+	FixedArray& operator=(FixedArray const&) = delete;
+
+	/// <summary>
+	/// @brief Allocates room for exactly t_capacity elements. Only allowed while empty.
+	/// </summary>
+	void reserve(std::size_t t_capacity)
+	{
+		if (m_size > 0)
+		{
+			throw std::runtime_error("FixedArray::reserve called while holding elements");
+		}
+
+		m_allocator.deallocate(m_data, m_capacity);
+
+		m_data = (t_capacity > 0) ? m_allocator.allocate(t_capacity) : nullptr;
+		m_capacity = t_capacity;
+	}
+
+	/// <summary>
+	/// @brief Constructs a new element at the end, in place
+	/// </summary>
+	template <typename... Args>
+	T& emplace_back(Args&&... t_args)
+	{
+		if (m_size == m_capacity)
+		{
+			throw std::runtime_error("FixedArray is full");
+		}
+
+		T* element = new (m_data + m_size) T(std::forward<Args>(t_args)...);
+		m_size++;
+
+		return *element;
+	}
+
+	/// <summary>
+	/// @brief Destroys every element, newest first, keeping the allocation
+	/// </summary>
+	void clear()
+	{
+		while (m_size > 0)
+		{
+			m_data[--m_size].~T();
+		}
+	}
+
+	inline std::size_t size() const { return m_size; }
+	inline std::size_t capacity() const { return m_capacity; }
+	inline bool empty() const { return 0 == m_size; }
+
+	inline T& operator[](std::size_t t_index) { return m_data[t_index]; }
+	inline T const& operator[](std::size_t t_index) const { return m_data[t_index]; }
+
+	inline T* begin() { return m_data; }
+	inline T* end() { return m_data + m_size; }
+	inline T const* begin() const { return m_data; }
+	inline T const* end() const { return m_data + m_size; }
+
+private:
+	std::allocator<T> m_allocator;
+	T* m_data{ nullptr };
+	std::size_t m_size{ 0 };
+	std::size_t m_capacity{ 0 };
+};
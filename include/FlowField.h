@@ -0,0 +1,70 @@
+#pragma once
+
+#include <SFML/System/Vector2.hpp>
+#include <utility>
+#include <vector>
+#include "Obstacle.h"
+
+/// <summary>
+/// @brief Directions to one goal from every tile of the world, shared by every tank heading there.
+///
+/// The world is split into TILE_SIZE tiles; any tile a tank can't sit in without touching a rock
+/// is blocked. A Dijkstra fill from the goal's tile over the open tiles gives each tile its
+/// distance to the goal and the neighbour to head for, so any number of tanks can look up
+/// their next step in constant time. The fill is only redone when the goal moves to another tile.
+/// </summary>
+class FlowField
+{
+public:
+	FlowField();
+
+	/// <summary>
+	/// @brief Marks every tile too close to an obstacle as blocked. Obstacles never move, so this is done once per world
+	/// </summary>
+	/// <param name="t_obstacles">the level's obstacles</param>
+	void build(std::vector<Obstacle>& t_obstacles);
+
+	/// <summary>
+	/// @brief Points the field at a new goal, refilling it only if the goal is on a different tile from last time
+	/// </summary>
+	/// <param name="t_goal">world position to head for</param>
+	/// <returns>true if the field was refilled</returns>
+	bool update(sf::Vector2f t_goal);
+
+	/// <summary>
+	/// @brief Which way to head from a position to reach the goal round the obstacles
+	/// </summary>
+	/// <param name="t_position">world position</param>
+	/// <returns>unit vector, or zero if already on the goal's tile, off the map, or there's no way through</returns>
+	sf::Vector2f getDirection(sf::Vector2f t_position) const;
+
+	// Side length of a tile, in pixels
+	static constexpr float TILE_SIZE = 40.0f;
+
+	// Tiles whose centre is closer than this to an obstacle are blocked; about half a tank's width
+	static constexpr float CLEARANCE = 24.0f;
+
+private:
+	/// <summary>
+	/// @brief Tile index of a world position, or -1 if it's off the map
+	/// </summary>
+	int getTile(sf::Vector2f t_position) const;
+
+	/// <summary>
+	/// @brief Refills the distances and directions outward from the goal tile
+	/// </summary>
+	void fill();
+
+	int m_cols;
+	int m_rows;
+
+	// Per tile, indexed row * m_cols + col
+	std::vector<char> m_blocked;
+	std::vector<float> m_distance;
+	std::vector<sf::Vector2f> m_direction;
+
+	// Dijkstra's open set as a min-heap of (distance, tile), reused between fills
+	std::vector<std::pair<float, int>> m_open;
+
+	int m_goalTile{ -1 };
+};
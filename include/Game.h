@@ -5,19 +5,15 @@
 #include <SFML/Graphics.hpp>
 #include <SFML/Audio.hpp>
 #include <Thor/Time.hpp>
+#include <array>
 #include "ScreenSize.h"
-#include "CellResolution.h"
-#include "Tank.h"
-#include "TankAI.h"
-#include "Target.h"
-#include "Obstacle.h"
+#include "GameWorld.h"
+#include "InputScript.h"
 
 #include "GameState.h"
 #include "GameData.h"
 #include "HUD.h"
 
-#include <map>
-#include <list>
 
 /// <summary>
 /// @author RP
@@ -44,22 +40,45 @@ public:
 	/// @brief Default constructor that initialises the SFML window, 
 	///   and sets vertical sync enabled. 
 	/// </summary>
-	Game();
+	/// <param name="t_seed">Seeds the world; recorded with the input so the headless runner can replay the match</param>
+	explicit Game(unsigned t_seed);
 
 	/// <summary>
 	/// @brief the main game loop.
 	/// 
 	/// A complete loop involves processing SFML events, updating and drawing all game objects.
-	/// The actual elapsed time for a single game loop results (lag) is stored. If this value is 
-	///  greater than the notional time for one loop (MS_PER_UPDATE), then additional updates will be 
-	///  performed until the lag is less than the notional time for one loop.
-	/// The target is one update and one render cycle per game loop, but slower PCs may 
-	///  perform more update than render operations in one loop.
+	/// The actual elapsed time for a single game loop results (lag) is stored. Updates are only
+	///  ever run in whole fixed steps (m_timeStep), as many as the lag covers, up to 
+	///  MAX_UPDATES_PER_FRAME. Whatever is left over says how far the frame is between the last
+	///  two steps, and rendering interpolates each entity by that much.
 	/// </summary>
 	void run();
 
+	/// <summary>
+	/// @brief Sets how many fixed simulation steps run per second, independent of the frame rate
+	/// </summary>
+	/// <param name="t_updatesPerSecond">Simulation rate in Hz, e.g. 30 on weak machines</param>
+	void setUpdateRate(unsigned t_updatesPerSecond);
+
+	/// <summary>
+	/// @brief Records the player's input for every update, along with the world seed and update rate,
+	/// to be saved when the window closes or the match is restarted. Only the first match is recorded,
+	/// as a restarted match carries on the world's random stream and can't be replayed from the seed.
+	/// The recording can be replayed by the headless runner. While recording, the AI perception budget
+	/// and view area are off, as they are headless, so every tank looks around on the same ticks in both.
+	/// </summary>
+	/// <param name="t_path">File to save the recording to</param>
+	void recordInput(std::string const& t_path);
+
 private: 
 
+	/// <summary>
+	/// @brief Loads the given level, reporting any failure before passing it on
+	/// </summary>
+	/// <param name="t_levelNumber">Which level to load</param>
+	/// <returns>The loaded level data</returns>
+	static LevelData loadLevel(int t_levelNumber);
+
 	/// <summary>
 	/// @brief Loads all game textures from file
 	/// </summary>
@@ -86,102 +105,101 @@ private:
 	void init();
 
 	/// <summary>
-	/// @brief Pull our wall data from file and assign it to our obstacles
+	/// @brief Plays sounds and score popups for everything the world reported this update, then clears the queue
 	/// </summary>
-	void generateWalls();
+	void processWorldEvents();
 
 	/// <summary>
-	/// @brief Pull our target data from file and assign it to our target vector
+	/// @brief Plays a positional sound effect on the next free channel
 	/// </summary>
-	void generateTargets();
+	/// <param name="t_buffer">Sound to play</param>
+	/// <param name="t_position">World position of the sound</param>
+	void playEffect(sf::SoundBuffer const& t_buffer, sf::Vector2f t_position);
 
 	/// <summary>
-	/// @brief Takes a vector of game objects, calculates their grid position, and associates them with our spacial map
+	/// @brief Shakes the sf::view based off our trauma variable and centres it on the player
 	/// </summary>
-	void buildMap();
+	/// <param name="t_alpha">How far the frame is between the previous update (0) and the latest (1)</param>
+	void shakeScreen(float t_alpha);
 
 	/// <summary>
-	/// @brief Checks if any active targets have been hit
+	/// @brief Where the camera centres: mostly on the player, kept inside the background
 	/// </summary>
-	void checkTargetsHit();
+	/// <param name="t_alpha">How far the frame is between the previous update (0) and the latest (1)</param>
+	/// <param name="t_shake">Translational screen shake, zero for the steady camera</param>
+	sf::Vector2f cameraCentre(float t_alpha, sf::Vector2f t_shake) const;
 
 	/// <summary>
-	/// @brief Calculates a score based on how long the player took to get a target
+	/// @brief Decrease deltaScoreText opacity until it disappears
 	/// </summary>
-	/// <param name="t_timeToHit">Time between target appearing and being hit/collected</param>
-	/// <returns>Target score to add to total score</returns>
-	int calculateScore(sf::Time t_timeToHit);
+	void fadeDeltaScoreText();
 
 	/// <summary>
-	/// @brief Shakes the sf::view based off our trauma variable
+	/// @brief Copies this update's collision stage counters into the debug text, then zeroes them
 	/// </summary>
-	void shakeScreen();
+	void updateCollisionStats();
 
 	/// <summary>
-	/// @brief Decrease deltaScoreText opacity until it disappears
+	/// @brief Copies the world's particle draw calls, particle, emitter and affector counts into the debug text
 	/// </summary>
-	void fadeDeltaScoreText();
+	void updateParticleStats();
 
 	/// <summary>
-	/// @brief pulls the next target into our active target array
+	/// @brief Rebuilds the profiler overlay from the latest samples, at most a few times a second
 	/// </summary>
-	void nextTarget();
+	void updateProfilerOverlay();
 
 	/// <summary>
-	/// Gets the angle between the mouse and the tank, and assign the turret that angle
+	/// @brief Writes out the input recording, if there is one, and stops recording
 	/// </summary>
-	void getTurretRotation();
+	void finishRecording();
 
 	/// <summary>
-	/// Poll SF keyboard to check current state of keys
+	/// Poll SF keyboard and mouse to build this update's player controls
 	/// </summary>
-	void handleKeyInput();
+	PlayerInput readInput();
 
 	/// <summary>
 	/// @brief Draws our PAUSE overlay with flashing text
 	/// </summary>
 	void drawPauseScreen();
 
-	/// <summary>
-	/// @brief Ends the game, upstates highscores
-	/// </summary>
-	void gameOver();
-
 	// Keep track of the state of the game
 	GameState m_gameState{ GameState::Loading };
 
-	// Heads up display showing gamestate etc.
-	HUD m_HUD;
+	// Length of one simulation step
+	sf::Time m_timeStep{ sf::seconds(1.0f / 60.0f) };
 
-	// stores the data for our level
-	LevelData m_level;
+	// A texture for the spritesheet (declared before the world, whose sprites use it)
+	sf::Texture m_spriteSheetTexture;
 
-	sf::Texture m_menuBackgroundTexture;
-	sf::Sprite m_menuBackgroundSprite;
+	// Textures for the tanks' particle effects
+	sf::Texture m_smokeTexture;
+	sf::Texture m_sparkTexture;
 
-	// a mapping of our partition spaces to the sprites occupying them
-	std::map<int, std::list<GameObject*>> m_spatialMap;
+	// Workers the world spreads its AI tank updates across
+	ThreadPool m_aiWorkers;
 
-	// keeps track of game time
-	thor::StopWatch m_gameClock;
+	// The level, tanks, targets and scoring; everything that isn't presentation
+	GameWorld m_world;
 
-	// Track how long the player took to get an obstacle
-	thor::StopWatch m_targetClock;
+	// Heads up display showing gamestate etc.
+	HUD m_HUD;
+
+	sf::Texture m_menuBackgroundTexture;
+	sf::Sprite m_menuBackgroundSprite;
 
 	// background sprite
 	sf::Texture m_bgTexture;
 	sf::Sprite m_bgSprite;
 
-	// obstacles
-	std::vector<Obstacle> m_obstacles;
+	// C was pressed since the last update
+	bool m_toggleTurretPending{ false };
 
-	// target sprites
-	std::vector<sf::Sprite> m_allTargets;
-	std::vector<Target> m_activeTargets;
-	int m_targetIndex{ 0 }; // track which target is active
-
-	// A texture for the spritesheet
-	sf::Texture m_spriteSheetTexture;
+	// Optional recording of every update's input; empty path when not recording
+	InputScript m_inputRecording;
+	std::string m_recordPath;
+	unsigned m_tick{ 0 };
 
 	// font and text
 	sf::Font m_font;
@@ -203,18 +221,9 @@ private:
 	sf::SoundBuffer m_backgroundMusicBuffer;
 	sf::Music m_backgroundMusic;
 
-	// An instance representing the player controlled tank.
-	Tank m_tank;
-
-	// An instance representing the AI controlled tank.
-	//std::array<TankAi*, 4U> m_aiTank;
-
-	TankAi m_topLeftAI;
-	TankAi m_topRightAI;
-	TankAi m_bottomLeftAI;
-	TankAi m_bottomRightAI;
-
-	GameData m_gameData;
+	// Channels for firing/impact sounds, reused round-robin so shots can overlap
+	std::array<sf::Sound, 8U> m_effectSounds;
+	unsigned m_nextEffectSound{ 0 };
 
 	// Shows the player how much time was added on destroying target
 	sf::Text m_deltaScoreText;
@@ -224,11 +233,21 @@ private:
 	thor::StopWatch m_deltaScoreClock;
 
 	// SCREENSHAKE variables
-	float m_trauma{ 0.0f }; // scalar for screenshake, normalised to the range 0-1
 	const float MAX_OFFSET = 50.0f; // max translational offset for screenshake
 	const float MAX_ANGLE = 5.0f; // max rotational offset for screenshake
 	sf::Text m_traumaMeter;
 
+	// Debug readout of how many collision pairs each broadphase stage rejected last update
+	sf::Text m_collisionStatsText;
+
+	// Debug readout of particle draw calls, and live particles, emitters and affectors over every particle system
+	sf::Text m_particleStatsText;
+
+	// Rolling section timings, toggled with F3
+	sf::Text m_profilerText;
+	bool m_showProfiler{ false };
+	sf::Clock m_profilerRefreshClock;
+
 protected:
 	/// <summary>
 	/// @brief Placeholder to perform updates to all game objects.
@@ -240,7 +259,8 @@ protected:
 	/// @brief Draws the background and foreground game objects in the SFML window.
 	/// The render window is always cleared to black before anything is drawn.
 	/// </summary>
-	void render();
+	/// <param name="t_alpha">How far the frame is between the previous update (0) and the latest (1)</param>
+	void render(float t_alpha);
 
 	/// <summary>
 	/// @brief Checks for events.
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <SFML/System/Vector2.hpp>
+#include <vector>
+
+/// <summary>
+/// @brief Something that happened in the simulation which the presentation layer may want to react to
+/// (play a sound, pop up a score), or a headless run may want to count.
+/// </summary>
+struct GameEvent
+{
+	enum class Type
+	{
+		EnemyFired,
+		ShellImpact,
+		PlayerHit,
+		EnemyHit,
+		TargetCollected,
+		PlayerWon,
+		PlayerLost
+	};
+
+	Type type;
+
+	// Where it happened, in world coordinates
+	sf::Vector2f position{ 0.0f,0.0f };
+
+	// Event specific value, e.g. the score awarded for a target
+	int value{ 0 };
+};
+
+// Events are appended during an update and drained by whoever owns the simulation
+using EventQueue = std::vector<GameEvent>;
@@ -1,13 +1,23 @@
 #pragma once
 #include <SFML/Graphics.hpp>
+#include "OrientedBoundingBox.h"
 
 class GameObject
 {
 public:
 	virtual sf::Sprite& getSprite() { return m_sprite; }
 
+	/// <summary>
+	/// @brief Returns the oriented box around our sprite, only recalculated after it moves or turns
+	/// </summary>
+	/// <returns>Cached bounding box</returns>
+	OrientedBoundingBox const& getBoundingBox() { m_boundingBox.Refresh(getSprite()); return m_boundingBox; }
+
 	virtual void hit() = 0;
 
 protected:
 	sf::Sprite m_sprite;
+
+	// cached collision box for getSprite(), mutable so const accessors can refresh it
+	mutable OrientedBoundingBox m_boundingBox;
 };
\ No newline at end of file
@@ -0,0 +1,252 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <random>
+#include "SimStopWatch.h"
+#include "CellResolution.h"
+#include "SpatialGrid.h"
+#include "Tank.h"
+#include "TankAI.h"
+#include "Target.h"
+#include "Obstacle.h"
+#include "FixedArray.h"
+#include "ThreadPool.h"
+#include "PerceptionScheduler.h"
+#include "FlowField.h"
+#include "NavMesh.h"
+#include "ParticleManager.h"
+
+#include "GameData.h"
+#include "GameEvent.h"
+#include "PlayerInput.h"
+#include "LevelLoader.h"
+
+/// <summary>
+/// @brief Everything that makes up a match: the level, the player and AI tanks, targets and scoring.
+///
+/// Owns no window and no audio. Each update takes a PlayerInput and a delta time and reports
+/// what happened through an event queue, so the same simulation can be driven by Game or
+/// stepped as fast as possible by the headless runner.
+/// </summary>
+class GameWorld
+{
+public:
+	/// <summary>
+	/// @brief How the current match stands
+	/// </summary>
+	enum class Outcome
+	{
+		InProgress,
+		PlayerWon,
+		PlayerLost
+	};
+
+	/// <summary>
+	/// @brief Builds the level's walls, targets and tanks
+	/// </summary>
+	/// <param name="t_spriteSheet">Sprite sheet texture, may be empty when nothing will be drawn</param>
+	/// <param name="t_level">Level data to build from</param>
+	/// <param name="t_seed">Seeds the match's random stream; the same seed and input replay the same match</param>
+	GameWorld(sf::Texture const& t_spriteSheet, LevelData const& t_level, unsigned t_seed);
+
+	/// <summary>
+	/// @brief Sets up a new match
+	/// </summary>
+	void init();
+
+	/// <summary>
+	/// @brief Steps the simulation by one tick
+	/// </summary>
+	/// <param name="t_input">Player controls for this tick</param>
+	/// <param name="t_dt">Simulation time to advance by</param>
+	void update(PlayerInput const& t_input, sf::Time t_dt);
+
+	/// <summary>
+	/// @brief Draws the walls, targets and tanks
+	/// </summary>
+	/// <param name="t_window">The SFML Render window</param>
+	/// <param name="t_alpha">How far the frame is between the previous update (0) and the latest (1)</param>
+	void render(sf::RenderWindow& t_window, float t_alpha);
+
+	/// <summary>
+	/// @brief Spreads the AI tanks' updates across the given pool's workers.
+	/// Without one (the default) they run one after another; the results are the same either way
+	/// </summary>
+	/// <param name="t_pool">Pool to use, or nullptr. Must not be a pool this world is itself being updated on</param>
+	inline void setThreadPool(ThreadPool* t_pool) { m_threadPool = t_pool; }
+
+	/// <summary>
+	/// @brief Caps how much time the AI tanks may spend looking around each tick (see PerceptionScheduler).
+	/// Makes matches depend on machine speed, so leave it off where runs must be reproducible
+	/// </summary>
+	/// <param name="t_budget">Budget per tick, or sf::Time::Zero for no limit (the default)</param>
+	inline void setPerceptionBudget(sf::Time t_budget) { m_perception.setBudget(t_budget); }
+
+	/// <summary>
+	/// @brief Tells the world what the player can currently see; AI tanks outside it look around less often
+	/// </summary>
+	/// <param name="t_area">Visible area in world coordinates, or an empty rect if unknown (the default)</param>
+	inline void setViewArea(sf::FloatRect t_area) { m_viewArea = t_area; }
+
+	inline PerceptionScheduler const& getPerceptionScheduler() const { return m_perception; }
+
+	/// <summary>
+	/// @brief Hands the smoke and spark textures to the world's particles
+	/// </summary>
+	inline void setParticleTextures(sf::Texture const& t_smoke, sf::Texture const& t_spark) { m_particles.setTextures(t_smoke, t_spark); }
+
+	inline ParticleManager const& getParticles() const { return m_particles; }
+
+	/// <summary>
+	/// @brief Tells the world's particles how long the last frame took, so they can emit less when frames run long
+	/// </summary>
+	inline void adaptParticlesToFrameTime(sf::Time t_frameTime) { m_particles.adaptToFrameTime(t_frameTime); }
+
+	inline Outcome getOutcome() const { return m_outcome; }
+
+	/// <summary>
+	/// @brief Events raised since the queue was last cleared; the caller is responsible for clearing it
+	/// </summary>
+	inline EventQueue& getEvents() { return m_events; }
+
+	inline GameData& getGameData() { return m_gameData; }
+
+	inline LevelData const& getLevel() const { return m_level; }
+
+	inline Tank const& getPlayerTank() const { return m_tank; }
+
+	inline std::size_t getAiTankCount() const { return m_aiTanks.size(); }
+
+	// Screenshake trauma, normalised to the range 0-1
+	inline float getTrauma() const { return m_trauma; }
+
+	// Simulation time since init()
+	inline sf::Time getMatchTime() const { return m_gameClock.getElapsedTime(); }
+
+private:
+
+	/// <summary>
+	/// @brief Pull our wall data from the level and assign it to our obstacles
+	/// </summary>
+	void generateWalls();
+
+	/// <summary>
+	/// @brief Pull our target data from the level and assign it to our target vector
+	/// </summary>
+	void generateTargets();
+
+	/// <summary>
+	/// @brief Registers the active targets with our spatial grid, replacing the previous set
+	/// </summary>
+	void registerTargets();
+
+	/// <summary>
+	/// @brief Applies one tick of player controls to the player tank
+	/// </summary>
+	void applyInput(PlayerInput const& t_input, sf::Time t_dt);
+
+	/// <summary>
+	/// @brief Updates every AI tank, in parallel if we have a pool, then commits their
+	/// side effects one tank at a time in roster order so the outcome never depends on scheduling
+	/// </summary>
+	void updateAiTanks(sf::Time t_dt);
+
+	/// <summary>
+	/// @brief Tells each AI tank whether it looks around this tick
+	/// </summary>
+	void schedulePerception();
+
+	/// <summary>
+	/// @brief Checks if any active targets have been hit
+	/// </summary>
+	void checkTargetsHit();
+
+	/// <summary>
+	/// @brief Calculates a score based on how long the player took to get a target
+	/// </summary>
+	/// <param name="t_timeToHit">Time between target appearing and being hit/collected</param>
+	/// <returns>Target score to add to total score</returns>
+	int calculateScore(sf::Time t_timeToHit);
+
+	/// <summary>
+	/// @brief pulls the next target into our active target array
+	/// </summary>
+	void nextTarget();
+
+	/// <summary>
+	/// @brief Ends the match with the given outcome
+	/// </summary>
+	void endMatch(Outcome t_outcome);
+
+	// stores the data for our level
+	LevelData m_level;
+
+	sf::Texture const& m_spriteSheetTexture;
+
+	// a mapping of our partition spaces to the sprites occupying them
+	SpatialGrid m_spatialGrid;
+
+	// routes round the rocks to the player, for AI tanks following them
+	FlowField m_flowField;
+
+	// routes round the rocks between any two points, for AI tanks on patrol
+	NavMesh m_navMesh;
+
+	// every random decision in the match comes from here, never from rand()
+	std::mt19937 m_random;
+
+	// things that happened this tick, for sound/score popups/statistics
+	EventQueue m_events;
+
+	// every tank's smoke and sparks, drawn together after the tanks
+	ParticleManager m_particles;
+
+	// keeps track of match time
+	SimStopWatch m_gameClock;
+
+	// Track how long the player took to get a target
+	SimStopWatch m_targetClock;
+
+	// obstacles
+	std::vector<Obstacle> m_obstacles;
+
+	// target sprites
+	std::vector<sf::Sprite> m_allTargets;
+	std::vector<Target> m_activeTargets;
+	std::vector<int> m_targetProxies; // grid handles for the active targets
+	int m_targetIndex{ 0 }; // track which target is active
+
+	// scalar for screenshake, normalised to the range 0-1
+	float m_trauma{ 0.0f };
+	static constexpr float TRAUMA_DECAY = 0.3f; // trauma lost per second
+
+	// An instance representing the player controlled tank.
+	Tank m_tank;
+
+	// One AI tank per spawn in the level file, built in place and never moved
+	FixedArray<TankAi> m_aiTanks;
+
+	// Patrol zone for AI tanks whose level entry doesn't give one
+	const sf::FloatRect WHOLE_MAP{ 50.0f, 50.0f, 2830.0f, 1700.0f };
+
+	// Workers for the AI updates, not owned; nullptr runs them on the calling thread
+	ThreadPool* m_threadPool{ nullptr };
+
+	// Spreads the AI tanks' looks across ticks, with scratch space for its input and output
+	PerceptionScheduler m_perception;
+	std::vector<PerceptionScheduler::Need> m_perceptionNeeds;
+	std::vector<char> m_perceiving;
+
+	// What the player can see, empty if unknown
+	sf::FloatRect m_viewArea;
+
+	// Below this many AI tanks, handing them to the pool costs more than it saves
+	static constexpr std::size_t MIN_PARALLEL_AI = 8;
+
+	// Tasks per worker, so a slow tank doesn't leave the other workers idle
+	static constexpr std::size_t AI_TASKS_PER_THREAD = 4;
+
+	GameData m_gameData;
+
+	Outcome m_outcome{ Outcome::InProgress };
+};
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "PlayerInput.h"
+
+/// <summary>
+/// @brief A tick-indexed recording of player input.
+/// 
+/// Stored run-length style: an entry is only kept when the input changes, and it holds
+/// until the next entry. Game records into one while playing; the headless runner plays
+/// one back so a match can be replayed deterministically without a window. The script
+/// also carries the world seed and simulation rate it was recorded with, since the same
+/// input only replays the same match on the same level layout at the same step length.
+/// 
+/// File format is a header line, then one entry per line:
+///		seed <seed> hz <updatesPerSecond>
+///		tick forward back left right toggleTurretFree aimX aimY
+/// Scripts without the header replay with seed 0 at 60Hz.
+/// </summary>
+class InputScript
+{
+public:
+	/// <summary>
+	/// @brief Reads a script from file, replacing the current entries
+	/// </summary>
+	/// <param name="t_path">Path to the script file</param>
+	void load(std::string const& t_path);
+
+	/// <summary>
+	/// @brief Writes the script out to file
+	/// </summary>
+	/// <param name="t_path">Path to the script file</param>
+	void save(std::string const& t_path) const;
+
+	/// <summary>
+	/// @brief Adds the input for a tick, if it differs from the input already in effect
+	/// </summary>
+	/// <param name="t_tick">Simulation tick, must not be less than the last recorded tick</param>
+	/// <param name="t_input">Player controls for that tick</param>
+	void record(unsigned t_tick, PlayerInput const& t_input);
+
+	/// <summary>
+	/// @brief Gets the input in effect at a tick
+	/// </summary>
+	/// <param name="t_tick">Simulation tick</param>
+	/// <returns>The most recent recorded input at or before that tick, or no input at all</returns>
+	PlayerInput getInput(unsigned t_tick) const;
+
+	inline void setSeed(unsigned t_seed) { m_seed = t_seed; }
+
+	inline unsigned getSeed() const { return m_seed; }
+
+	inline void setUpdateRate(unsigned t_updatesPerSecond) { m_updateRate = t_updatesPerSecond; }
+
+	inline unsigned getUpdateRate() const { return m_updateRate; }
+
+	/// <summary>
+	/// @brief Removes every entry; the seed and update rate are kept
+	/// </summary>
+	inline void clear() { m_entries.clear(); }
+
+	inline bool empty() const { return m_entries.empty(); }
+
+private:
+	struct Entry
+	{
+		unsigned tick;
+		PlayerInput input;
+	};
+
+	std::vector<Entry> m_entries;
+
+	// World seed and simulation rate the input was recorded against
+	unsigned m_seed{ 0 };
+	unsigned m_updateRate{ 60 };
+};
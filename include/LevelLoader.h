@@ -1,6 +1,7 @@
 #pragma once
 
 #include <SFML/System/Vector2.hpp>
+#include <SFML/Graphics/Rect.hpp>
 #include <vector>
 #include <sstream>
 #include <fstream>
@@ -40,13 +41,19 @@ struct BackgroundData
 /// </summary>
 struct TankData
 {
-	std::vector<sf::Vector2f> m_position
-	{
-		sf::Vector2f(0.0f,0.0f),
-		sf::Vector2f(0.0f,0.0f),
-		sf::Vector2f(0.0f,0.0f),
-		sf::Vector2f(0.0f,0.0f)
-	};
+	// possible spawn points, one is picked at random
+	std::vector<sf::Vector2f> m_position;
+};
+
+/// <summary>
+/// @brief A struct to represent one AI tank in the level.
+/// </summary>
+struct AiTankData
+{
+	sf::Vector2f m_position;
+
+	// Area to patrol; zero size means the whole map
+	sf::FloatRect m_patrolZone;
 };
 
 /// <summary>
@@ -58,7 +65,7 @@ struct LevelData
 {
 	BackgroundData m_background;
 	TankData m_tank;
-	TankData m_aiTank;
+	std::vector<AiTankData> m_aiTanks;
 	std::vector<ObstacleData> m_obstacles;
 	std::vector<TargetData> m_targets;
 };
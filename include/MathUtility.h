@@ -28,8 +28,10 @@ namespace MathUtility
 	/// </summary>
 	/// <param name="ahead">The ahead vector of the tank</param>
 	/// <param name="halfAhead">Assumed to be half the length of the ahead vector</param>
+	/// <param name="centre">Centre of the circle</param>
+	/// <param name="radius">Radius of the circle</param>
 	/// <returns>true if either vector is inside the radius of the specified circle.</returns>
-	bool lineIntersectsCircle(sf::Vector2f ahead, sf::Vector2f halfAhead, sf::CircleShape circle);
+	bool lineIntersectsCircle(sf::Vector2f ahead, sf::Vector2f halfAhead, sf::Vector2f centre, float radius);
 
 	/// <summary>
 	/// @brief Truncates the supplied vector so that its length is not greater than the specified number. 
@@ -39,4 +41,38 @@ namespace MathUtility
 	/// <param name="max">The maximum length of the vector</param>
 	/// <returns>A vector whose length is not longer than the specified maximum.</returns>
 	sf::Vector2f truncate(sf::Vector2f v, float const max);
+
+	/// <summary>
+	/// @brief Finds where a ray first enters a circle.
+	/// </summary>
+	/// <param name="origin">Start of the ray</param>
+	/// <param name="direction">Unit direction of the ray</param>
+	/// <param name="centre">Centre of the circle</param>
+	/// <param name="radius">Radius of the circle</param>
+	/// <returns>Distance along the ray to the circle, 0 if the origin is inside it, infinity if the ray misses.</returns>
+	float rayCircleIntersection(sf::Vector2f origin, sf::Vector2f direction, sf::Vector2f centre, float radius);
+
+	/// <summary>
+	/// @brief Returns the smallest rectangle containing both of the supplied rectangles.
+	/// </summary>
+	/// <param name="a">A world space rectangle</param>
+	/// <param name="b">A world space rectangle</param>
+	/// <returns>The union of a and b.</returns>
+	sf::FloatRect unite(sf::FloatRect const& a, sf::FloatRect const& b);
+
+	/// <summary>
+	/// @brief Linear interpolation between two points.
+	/// </summary>
+	/// <param name="a">Value at t = 0</param>
+	/// <param name="b">Value at t = 1</param>
+	/// <param name="t">Blend factor, normally in the range 0-1</param>
+	sf::Vector2f lerp(sf::Vector2f a, sf::Vector2f b, float t);
+
+	/// <summary>
+	/// @brief Interpolates between two angles in degrees, turning the short way round.
+	/// </summary>
+	/// <param name="a">Angle at t = 0</param>
+	/// <param name="b">Angle at t = 1</param>
+	/// <param name="t">Blend factor, normally in the range 0-1</param>
+	float lerpAngle(float a, float b, float t);
 }
\ No newline at end of file
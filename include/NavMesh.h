@@ -0,0 +1,119 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "Obstacle.h"
+
+/// <summary>
+/// @brief Triangulation of the ground a tank can drive on, for long routes across the level.
+///
+/// Built once per world: every obstacle's box is grown by CLEARANCE and points round its outline,
+/// plus a loose lattice over the open ground, are Delaunay triangulated with thor::triangulate. Any
+/// triangle touching a grown box is thrown away, leaving triangles a tank's centre can cross
+/// without scraping a rock. Routes are A* over the triangles, pulled tight through the shared
+/// edges with the funnel algorithm.
+///
+/// The A* part only depends on which triangles the route starts and ends in, so it's cached
+/// per pair. findPath may be called from several threads at once.
+/// </summary>
+class NavMesh
+{
+public:
+	/// <summary>
+	/// @brief Triangulates the open ground between the obstacles. Obstacles never move, so this is done once per world
+	/// </summary>
+	/// <param name="t_obstacles">the level's obstacles</param>
+	/// <param name="t_bounds">the area the mesh should cover</param>
+	void build(std::vector<Obstacle>& t_obstacles, sf::FloatRect t_bounds);
+
+	/// <summary>
+	/// @brief Whether a tank could sit at this position without touching a rock
+	/// </summary>
+	inline bool contains(sf::Vector2f t_position) const { return findTriangle(t_position) != -1; }
+
+	/// <summary>
+	/// @brief Finds the shortest route round the obstacles
+	/// </summary>
+	/// <param name="t_start">where the route starts; if that's off the mesh, the route starts from the nearest triangle</param>
+	/// <param name="t_goal">where it should end, must be on the mesh</param>
+	/// <param name="t_path">set to the corners to drive through, ending with t_goal; cleared if there's no route</param>
+	/// <returns>true if a route was found</returns>
+	bool findPath(sf::Vector2f t_start, sf::Vector2f t_goal, std::vector<sf::Vector2f>& t_path) const;
+
+	/// <summary>
+	/// @brief Draws the triangles' outlines
+	/// </summary>
+	void render(sf::RenderWindow& t_window) const;
+
+	// Obstacle boxes are grown by this before triangulating; about half a tank's width
+	static constexpr float CLEARANCE = 24.0f;
+
+	// Greatest spacing of the vertices round each grown box
+	static constexpr float OUTLINE_SPACING = 40.0f;
+
+	// Spacing of the extra vertices scattered over open ground, so big open areas aren't covered by slivers
+	static constexpr float LATTICE_SPACING = 160.0f;
+
+private:
+	/// <summary>
+	/// @brief One walkable triangle
+	/// </summary>
+	struct Triangle
+	{
+		// vertex indices, wound so (b - a) x (c - a) is positive (clockwise on screen)
+		std::array<int, 3> corners;
+
+		// the triangle across the edge from corners[i] to corners[(i + 1) % 3], or -1
+		std::array<int, 3> neighbours{ -1, -1, -1 };
+
+		sf::Vector2f centre;
+	};
+
+	/// <summary>
+	/// @brief Index of the triangle containing a position, or -1 if it's off the mesh
+	/// </summary>
+	int findTriangle(sf::Vector2f t_position) const;
+
+	/// <summary>
+	/// @brief Index of the triangle containing a position, or failing that the one whose centre is closest
+	/// </summary>
+	int findNearestTriangle(sf::Vector2f t_position) const;
+
+	/// <summary>
+	/// @brief A* from one triangle to another, over the triangles' centres
+	/// </summary>
+	/// <param name="t_corridor">set to the triangles to pass through, both ends included; empty if there's no route</param>
+	void findCorridor(int t_start, int t_goal, std::vector<int>& t_corridor) const;
+
+	/// <summary>
+	/// @brief Pulls a route through a corridor of triangles tight round its corners
+	/// </summary>
+	void funnel(sf::Vector2f t_start, sf::Vector2f t_goal, std::vector<int> const& t_corridor, std::vector<sf::Vector2f>& t_path) const;
+
+	/// <summary>
+	/// @brief Index of the bucket holding a position, clamped to the mesh's bounds
+	/// </summary>
+	int getBucket(sf::Vector2f t_position) const;
+
+	std::vector<sf::Vector2f> m_vertices;
+	std::vector<Triangle> m_triangles;
+
+	// Triangles overlapping each BUCKET_SIZE square, so finding the triangle under a point only tests a handful
+	sf::FloatRect m_bounds;
+	int m_bucketCols{ 0 };
+	int m_bucketRows{ 0 };
+	std::vector<std::vector<int>> m_buckets;
+	static constexpr float BUCKET_SIZE = 80.0f;
+
+	// Corridors already found, keyed by start triangle in the high half and goal in the low half.
+	// Guarded by m_cacheMutex; corridors with no route are cached as empty
+	mutable std::unordered_map<std::uint64_t, std::vector<int>> m_corridors;
+	mutable std::mutex m_cacheMutex;
+
+	// The cache is simply emptied when it grows past this many corridors
+	static constexpr std::size_t MAX_CACHED_CORRIDORS = 4096;
+};
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <SFML/Graphics.hpp>
+#include <vector>
 
 /// <summary>
 /// @brief Collision detection class for bounding box collisions using the Separating Axis Theorem (SAT)
@@ -17,9 +18,44 @@
 class OrientedBoundingBox // Used in the BoundingBoxTest
 {
 public:
+	OrientedBoundingBox() = default;
 	OrientedBoundingBox(const sf::Sprite& Object); // Calculate the four points of the OBB from a transformed (scaled, rotated...) RectangleShape
 
 	sf::Vector2f Points[4];
+	sf::Vector2f Axes[2]; // The two edge directions of the box, which are all SAT needs from it
+	sf::FloatRect Bounds; // Axis aligned box around the four points
+	sf::Vector2f Centre; // Centre of the bounding circle
+	float Radius{ 0.0f }; // Radius of the bounding circle (half the diagonal)
 
-	void ProjectOntoAxis(const sf::Vector2f& Axis, float& Min, float& Max); // Project all four points of the OBB onto the given axis and return the dotproducts of the two outermost points
+	void Update(const sf::Sprite& Object); // Recalculate the points, axes and bounds from the sprite's current transform
+	bool Refresh(const sf::Sprite& Object); // Update only if the sprite has moved, turned or been resized since the last update, returns true if it did
+
+	void ProjectOntoAxis(const sf::Vector2f& Axis, float& Min, float& Max) const; // Project all four points of the OBB onto the given axis and return the dotproducts of the two outermost points
+
+private:
+	// Snapshot of the transform the points were last calculated from
+	bool Valid{ false };
+	sf::Vector2f Position;
+	float Rotation{ 0.0f };
+	sf::Vector2f Scale;
+	sf::Vector2f Origin;
+	sf::Vector2f Size;
+};
+
+class OrientedBoundingBoxBatch // Corners of many OBBs stored structure-of-arrays, for CollisionDetector's batched test
+{
+public:
+	void Clear(); // Remove all boxes
+	void Add(const OrientedBoundingBox& Box); // Append a copy of the box's corners
+	std::size_t Size() const { return X[0].size(); }
+
+	std::vector<float> X[4]; // X[corner][box]
+	std::vector<float> Y[4]; // Y[corner][box]
+	std::vector<float> CentreX; // Bounding circles, for the early-out before SAT
+	std::vector<float> CentreY;
+	std::vector<float> Radius;
+	std::vector<float> MinX; // AABBs, for the second early-out before SAT
+	std::vector<float> MaxX;
+	std::vector<float> MinY;
+	std::vector<float> MaxY;
 };
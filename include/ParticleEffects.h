@@ -0,0 +1,25 @@
+#pragma once
+
+#include "ParticleSystem.h"
+
+/// <summary>
+/// @brief The game's particle effects. Each particle system is given one of these with setEffect
+/// and then fires bursts of it, so its affectors are set up once however often it fires
+/// </summary>
+namespace ParticleEffects
+{
+	// Sparks thrown out of an AI tank's barrel when it fires
+	extern const ParticleEffect MUZZLE_SPARKS;
+
+	// Dust kicked up round an AI tank's barrel when it fires
+	extern const ParticleEffect MUZZLE_SMOKE;
+
+	// Dust where an AI tank's shell lands
+	extern const ParticleEffect IMPACT_SMOKE;
+
+	// Sparks off a damaged track of the player's tank, from a persistent emitter per track
+	extern const ParticleEffect TRACK_SPARKS;
+
+	// Smoke from the player's tank, from a persistent emitter whose rate is raised as the tank takes hits
+	extern const ParticleEffect ENGINE_SMOKE;
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <array>
+#include <vector>
+#include "ParticleSystem.h"
+
+/// <summary>
+/// @brief Every particle in the world, shown with one draw call per blend mode.
+///
+/// Holds one ParticleSystem per effect in ParticleEffects, shared by every tank: tanks fire bursts
+/// and keep persistent emitters here rather than owning systems of their own. The smoke and spark
+/// pictures are packed side by side into one atlas texture, so every system's quads can go into a
+/// single vertex buffer per blend mode, however many tanks there are. Only particles inside the
+/// target's view go into it.
+///
+/// Particles are rationed: every system has its effect's cap, and all of them share PARTICLE_BUDGET.
+/// Every system sheds its dead particles first, then they emit in priority order, each only into
+/// whatever room is left under the budget at its turn, so the budget is a hard limit on the total.
+/// Particles already alive are never evicted, but as they die the player's own smoke and sparks are
+/// first to take their place. When frames run long,
+/// every effect but the top priority emits less, so smoke thins out before the frame rate drops.
+///
+/// Not thread safe; bursts are only fired from the world's thread, e.g. from TankAi::commit.
+/// </summary>
+class ParticleManager : public sf::Drawable
+{
+public:
+	/// <summary>
+	/// @brief Identifies a persistent emitter: the system it's in, and its handle there
+	/// </summary>
+	struct EmitterHandle
+	{
+		std::size_t system;
+		ParticleSystem::EmitterHandle emitter;
+	};
+
+	ParticleManager();
+
+	/// <summary>
+	/// @brief Packs the smoke and spark pictures into our atlas. The originals can be freed afterwards
+	/// </summary>
+	void setTextures(sf::Texture const& t_smoke, sf::Texture const& t_spark);
+
+	/// <summary>
+	/// @brief Starts one burst of an effect
+	/// </summary>
+	/// <param name="t_effect">one of ParticleEffects</param>
+	/// <param name="t_position">where the particles start</param>
+	/// <param name="t_direction">unit vector the effect's velocity is turned to face</param>
+	void burst(ParticleEffect const& t_effect, sf::Vector2f t_position, sf::Vector2f t_direction = { 1.0f, 0.0f });
+
+	/// <summary>
+	/// @brief Adds a long-lived emitter of an effect, to be moved and retuned in place
+	/// </summary>
+	/// <param name="t_effect">one of ParticleEffects</param>
+	/// <param name="t_enabled">whether it starts emitting straight away</param>
+	EmitterHandle addPersistentEmitter(ParticleEffect const& t_effect, bool t_enabled = true);
+
+	inline ParticleEmitter& getEmitter(EmitterHandle t_handle) { return m_systems[t_handle.system].getEmitter(t_handle.emitter); }
+
+	inline void setEmitterEnabled(EmitterHandle t_handle, bool t_enabled) { m_systems[t_handle.system].setEmitterEnabled(t_handle.emitter, t_enabled); }
+
+	/// <summary>
+	/// @brief Removes every particle and burst and disables every persistent emitter, for a new match
+	/// </summary>
+	void clear();
+
+	/// <summary>
+	/// @brief Updates every system, emitting highest priority first, within the budget
+	/// </summary>
+	void update(sf::Time t_dt);
+
+	/// <summary>
+	/// @brief Feeds in how long the last frame took, to scale emission down when frames run over TARGET_FRAME_TIME
+	/// and back up when they don't
+	/// </summary>
+	void adaptToFrameTime(sf::Time t_frameTime);
+
+	inline float getEmissionScale() const { return m_emissionScale; }
+
+	/// <summary>
+	/// @brief Particle, emitter and affector counts over every system
+	/// </summary>
+	ParticleSystem::Stats getStats() const;
+
+	// Draw calls made by the last draw
+	inline std::size_t getDrawCallCount() const { return m_drawCalls; }
+
+	// Particles that were in view at the last draw
+	inline std::size_t getDrawnCount() const { return m_drawn; }
+
+	// Most particles alive at once over every system
+	static constexpr std::size_t PARTICLE_BUDGET = 5000;
+
+	// Frames longer than this thin out emission; a little over a 60Hz frame, so vsync's own wait doesn't count
+	static constexpr float TARGET_FRAME_TIME = 0.02f;
+
+	// Emission never thins out past this fraction of the full rate
+	static constexpr float MIN_EMISSION_SCALE = 0.25f;
+
+	// How much of each new frame time goes into the running average, so one slow frame doesn't throttle us
+	static constexpr float FRAME_TIME_SMOOTHING = 0.1f;
+
+	// Transparent pixels between the pictures in the atlas, so smoothing doesn't bleed one into the next
+	static constexpr unsigned ATLAS_PADDING = 2u;
+
+private:
+	void draw(sf::RenderTarget& t_target, sf::RenderStates t_states) const override;
+
+	/// <summary>
+	/// @brief Index of the system showing an effect; throws if the effect isn't one of ParticleEffects
+	/// </summary>
+	std::size_t findSystem(ParticleEffect const& t_effect) const;
+
+	// One per effect, in drawing order, so sparks land on top of smoke
+	std::vector<ParticleSystem> m_systems;
+
+	// Indices into m_systems, in the order they're served from the budget
+	std::vector<std::size_t> m_budgetOrder;
+
+	float m_smoothedFrameTime{ 1.0f / 60.0f };
+	float m_emissionScale{ 1.0f };
+
+	sf::Texture m_atlas;
+
+	// One vertex buffer per blend mode, indexed by ParticleBlend, rebuilt when drawn after an update or with a different view
+	static constexpr std::size_t BLEND_MODES = 2;
+	mutable std::array<std::vector<sf::Vertex>, BLEND_MODES> m_vertices;
+	mutable bool m_verticesStale{ true };
+	mutable sf::FloatRect m_builtArea;
+	mutable std::size_t m_drawCalls{ 0 };
+	mutable std::size_t m_drawn{ 0 };
+};
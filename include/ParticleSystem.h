@@ -0,0 +1,304 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+/// <summary>
+/// @brief Where a particle system spawns particles, how many, and what they start with.
+/// Copied into the system by addEmitter, so one set of settings can be reused for any number of bursts
+/// </summary>
+struct ParticleEmitter
+{
+	sf::Vector2f position;
+
+	// Particles per second; fractions carry over between updates
+	float emissionRate{ 0.0f };
+
+	// Starting velocity, turned by up to deflection degrees either way
+	sf::Vector2f velocity;
+	float deflection{ 0.0f };
+
+	// Each particle lives for a uniformly random time between these
+	sf::Time minLifetime{ sf::seconds(1.0f) };
+	sf::Time maxLifetime{ sf::seconds(1.0f) };
+
+	// Degrees, and degrees per second
+	float rotation{ 0.0f };
+	float rotationSpeed{ 0.0f };
+
+	sf::Vector2f scale{ 1.0f, 1.0f };
+	sf::Color colour{ sf::Color::White };
+};
+
+/// <summary>
+/// @brief Which picture a particle is drawn with
+/// </summary>
+enum class ParticleTexture
+{
+	Smoke,
+	Spark
+};
+
+/// <summary>
+/// @brief How a particle is blended over what's already drawn; ParticleManager makes one draw call per mode
+/// </summary>
+enum class ParticleBlend
+{
+	Alpha,
+	Additive
+};
+
+/// <summary>
+/// @brief A named kind of burst, such as a muzzle flash: the emitter each burst starts from, how long it
+/// emits for, and the affectors set up once on the system that shows it
+/// </summary>
+struct ParticleEffect
+{
+	// Position is set by each burst, and velocity is given as if firing along +x then turned to the burst's direction
+	ParticleEmitter emitter;
+
+	// How long each burst emits for; zero for effects shown by a persistent emitter instead
+	sf::Time burstDuration;
+
+	// Fractions of each particle's lifetime spent fading in and out
+	float fadeIn{ 0.0f };
+	float fadeOut{ 1.0f };
+
+	// Added to each particle's scale per second, zero for none
+	sf::Vector2f scaleRate;
+
+	ParticleTexture texture{ ParticleTexture::Smoke };
+	ParticleBlend blend{ ParticleBlend::Alpha };
+
+	// Most particles the effect's system may hold at once
+	std::size_t maxParticles{ 1000 };
+
+	// Order the effect is served from ParticleManager's budget, 0 first. Only priority 0 effects
+	// keep their full emission rate when frames run long
+	int priority{ 0 };
+};
+
+/// <summary>
+/// @brief Textured particles stored structure-of-arrays, in place of thor::ParticleSystem.
+///
+/// Particle i is element i of every array, so each stage of an update is one straight pass over
+/// the few arrays it needs, four particles at a time where SSE is available. Only the two affectors
+/// the game uses, fade and scale, are built in; each runs as one such pass rather than a call per
+/// particle. Dead particles are swapped with the last one and popped, so the arrays stay packed.
+///
+/// Every system has its own random engine, so separate systems can be updated from separate threads.
+/// Systems don't draw themselves; ParticleManager gathers every system's quads into one vertex buffer.
+/// </summary>
+class ParticleSystem
+{
+public:
+	/// <summary>
+	/// @brief Counts summed over any number of systems, for the debug overlay
+	/// </summary>
+	struct Stats
+	{
+		std::size_t systems{ 0 };
+		std::size_t particles{ 0 };
+		std::size_t emitters{ 0 };
+		std::size_t affectors{ 0 };
+
+		// The most affectors on any one system; should never grow during a match
+		std::size_t mostAffectors{ 0 };
+
+		// Particles not emitted because a system was at its limit, since it was last cleared
+		std::size_t dropped{ 0 };
+	};
+
+	/// <summary>
+	/// @brief Identifies an emitter added with addPersistentEmitter, for as long as the system lives
+	/// </summary>
+	using EmitterHandle = std::size_t;
+
+	ParticleSystem();
+
+	/// <summary>
+	/// @brief Makes this system show one effect, replacing its affectors with the effect's. Done once, not per burst
+	/// </summary>
+	/// <param name="t_effect">the effect, which must outlive the system; usually one of ParticleEffects</param>
+	void setEffect(ParticleEffect const& t_effect);
+
+	/// <summary>
+	/// @brief Starts one burst of our effect; only adds an emitter, which expires after the effect's burst duration
+	/// </summary>
+	/// <param name="t_position">where the particles start</param>
+	/// <param name="t_direction">unit vector the effect's velocity is turned to face</param>
+	void burst(sf::Vector2f t_position, sf::Vector2f t_direction = { 1.0f, 0.0f });
+
+	inline ParticleEffect const* getEffect() const { return m_effect; }
+
+	/// <summary>
+	/// @brief Sets the part of the drawing texture every particle shows; its size is the particles' unscaled size
+	/// </summary>
+	inline void setTextureRect(sf::FloatRect t_rect) { m_textureRect = t_rect; }
+
+	/// <summary>
+	/// @brief Caps how many particles we hold; emitters skip particles rather than go over
+	/// </summary>
+	inline void setParticleLimit(std::size_t t_limit) { m_particleLimit = t_limit; }
+
+	/// <summary>
+	/// @brief Multiplies every emitter's rate, to thin the effect out when frames run long
+	/// </summary>
+	inline void setEmissionScale(float t_scale) { m_emissionScale = t_scale; }
+
+	/// <summary>
+	/// @brief Starts emitting particles
+	/// </summary>
+	/// <param name="t_emitter">settings to emit with, copied</param>
+	/// <param name="t_duration">how long to keep emitting for, or zero to emit until clearEmitters</param>
+	void addEmitter(ParticleEmitter const& t_emitter, sf::Time t_duration = sf::Time::Zero);
+
+	/// <summary>
+	/// @brief Fades every particle in over the start of its life and out over the end
+	/// </summary>
+	/// <param name="t_fadeIn">fraction of its lifetime spent fading in</param>
+	/// <param name="t_fadeOut">fraction of its lifetime spent fading out</param>
+	/// <param name="t_duration">how long the affector lasts, or zero for as long as the system</param>
+	void addFadeAffector(float t_fadeIn, float t_fadeOut, sf::Time t_duration = sf::Time::Zero);
+
+	/// <summary>
+	/// @brief Grows every particle's scale
+	/// </summary>
+	/// <param name="t_rate">added to the scale per second</param>
+	/// <param name="t_duration">how long the affector lasts, or zero for as long as the system</param>
+	void addScaleAffector(sf::Vector2f t_rate, sf::Time t_duration = sf::Time::Zero);
+
+	/// <summary>
+	/// @brief Adds an emitter that lasts as long as the system, for effects that run continuously.
+	/// Move it and change its rate in place through getEmitter rather than adding a new emitter every tick
+	/// </summary>
+	/// <param name="t_emitter">settings to start with, copied</param>
+	/// <param name="t_enabled">whether it starts emitting straight away</param>
+	/// <returns>handle for getEmitter and setEmitterEnabled</returns>
+	EmitterHandle addPersistentEmitter(ParticleEmitter const& t_emitter, bool t_enabled = true);
+
+	inline ParticleEmitter& getEmitter(EmitterHandle t_handle) { return m_persistentEmitters[t_handle].settings; }
+
+	/// <summary>
+	/// @brief Starts or stops a persistent emitter; a stopped one costs nothing to update
+	/// </summary>
+	void setEmitterEnabled(EmitterHandle t_handle, bool t_enabled);
+
+	/// <summary>
+	/// @brief Stops every burst and disables every persistent emitter; handles stay valid
+	/// </summary>
+	void clearEmitters();
+	void clearAffectors();
+	void clearParticles();
+
+	/// <summary>
+	/// @brief Moves and ages every particle, applies the affectors, then lets the emitters spawn more
+	/// </summary>
+	void update(sf::Time t_dt);
+
+	/// <summary>
+	/// @brief The first half of update: moves and ages every particle, removes the dead and applies the affectors
+	/// </summary>
+	void updateParticles(sf::Time t_dt);
+
+	/// <summary>
+	/// @brief The second half of update: lets the emitters spawn particles, up to the particle limit
+	/// </summary>
+	void updateEmitters(sf::Time t_dt);
+
+	inline std::size_t getParticleCount() const { return m_positionX.size(); }
+	std::size_t getEmitterCount() const;
+	inline std::size_t getAffectorCount() const { return m_affectors.size(); }
+
+	/// <summary>
+	/// @brief Adds this system's counts to a running total
+	/// </summary>
+	void addStats(Stats& t_stats) const;
+
+	/// <summary>
+	/// @brief Appends one quad per particle that could be seen, to be drawn as sf::Quads with the texture our rect is in
+	/// </summary>
+	/// <param name="t_visibleArea">world area being drawn; particles wholly outside it are skipped</param>
+	void appendVertices(std::vector<sf::Vertex>& t_vertices, sf::FloatRect t_visibleArea) const;
+
+private:
+	/// <summary>
+	/// @brief An emitter that's been added, with the time it has left
+	/// </summary>
+	struct ActiveEmitter
+	{
+		ParticleEmitter settings;
+		sf::Time remaining;
+		bool timed;
+
+		// Fraction of a particle owed from previous updates
+		float pending{ 0.0f };
+
+		bool enabled{ true };
+	};
+
+	/// <summary>
+	/// @brief One of the built-in affectors, with the time it has left
+	/// </summary>
+	struct Affector
+	{
+		enum class Type { Fade, Scale };
+
+		Type type;
+		float fadeIn;
+		float fadeOut;
+		sf::Vector2f rate;
+		sf::Time remaining;
+		bool timed;
+	};
+
+	/// <summary>
+	/// @brief Emits however many particles an emitter owes for this update
+	/// </summary>
+	void runEmitter(ActiveEmitter& t_emitter, float t_dt);
+
+	/// <summary>
+	/// @brief Adds one particle's worth of every array, using the emitter's settings
+	/// </summary>
+	void emit(ParticleEmitter const& t_emitter);
+
+	// The update passes
+	void integrate(float t_dt);
+	void removeDead();
+	void fade(float t_fadeIn, float t_fadeOut);
+	void scale(sf::Vector2f t_rate, float t_dt);
+
+	// Particles, structure-of-arrays
+	std::vector<float> m_positionX;
+	std::vector<float> m_positionY;
+	std::vector<float> m_velocityX;
+	std::vector<float> m_velocityY;
+	std::vector<float> m_rotation;
+	std::vector<float> m_rotationSpeed;
+	std::vector<float> m_scaleX;
+	std::vector<float> m_scaleY;
+	std::vector<float> m_elapsed;
+	std::vector<float> m_lifetime;
+	std::vector<float> m_alpha;
+	std::vector<sf::Color> m_colour;
+
+	// Bursts, removed once their time is up
+	std::vector<ActiveEmitter> m_emitters;
+
+	// Never removed, so an EmitterHandle is an index into here
+	std::vector<ActiveEmitter> m_persistentEmitters;
+	std::vector<Affector> m_affectors;
+
+	sf::FloatRect m_textureRect;
+
+	std::size_t m_particleLimit{ SIZE_MAX };
+	float m_emissionScale{ 1.0f };
+	std::size_t m_dropped{ 0 };
+
+	// Set by setEffect; bursts copy its emitter
+	ParticleEffect const* m_effect{ nullptr };
+
+	std::minstd_rand m_random;
+};
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <SFML/System/Time.hpp>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/// <summary>
+/// @brief Decides which AI tanks look around (vision cone, nearby obstacles) on a given tick.
+///
+/// Each tank gets an interval from its situation: every tick while it's attacking the player,
+/// less often the further away and less visible it is. Tanks are started on different phases so
+/// their looks are spread across ticks rather than all landing together.
+///
+/// With a budget set, looks that are due but not urgent are also capped by how many fit in the
+/// budget at the measured average cost of a look, most overdue first. Measured costs depend on
+/// the machine, so leave the budget off wherever a run has to be reproducible.
+/// </summary>
+class PerceptionScheduler
+{
+public:
+	/// <summary>
+	/// @brief What the scheduler needs to know about one tank this tick
+	/// </summary>
+	struct Need
+	{
+		// attacking the player; never skipped
+		bool engaged{ false };
+
+		float distanceToPlayer{ 0.0f };
+
+		// inside the area the player can currently see
+		bool onScreen{ true };
+	};
+
+	/// <summary>
+	/// @brief Forgets all history and staggers the phases of the given number of tanks
+	/// </summary>
+	void reset(std::size_t t_count);
+
+	/// <summary>
+	/// @brief Sets the time all looks in one tick may take between them, summed over every thread
+	/// </summary>
+	/// <param name="t_budget">Budget per tick, or sf::Time::Zero for no limit (the default)</param>
+	inline void setBudget(sf::Time t_budget) { m_budget = t_budget; }
+
+	/// <summary>
+	/// @brief Chooses which tanks look around this tick
+	/// </summary>
+	/// <param name="t_needs">One entry per tank, in roster order</param>
+	/// <param name="t_perceive">Set to one entry per tank, non-zero for those that should look</param>
+	void schedule(std::vector<Need> const& t_needs, std::vector<char>& t_perceive);
+
+	/// <summary>
+	/// @brief Tells the scheduler how long this tick's looks took, to refine its cost estimate
+	/// </summary>
+	/// <param name="t_total">Time taken by all of them together</param>
+	/// <param name="t_count">How many there were</param>
+	void reportCost(sf::Time t_total, unsigned t_count);
+
+	// Looks that were due but pushed to a later tick to stay within budget, last tick
+	inline unsigned getDeferredCount() const { return m_deferred; }
+
+private:
+	/// <summary>
+	/// @brief How many ticks a tank in this situation may go between looks
+	/// </summary>
+	static unsigned intervalFor(Need const& t_need);
+
+	// Ticks since each tank last looked
+	std::vector<unsigned> m_waiting;
+
+	// Due but optional looks this tick, as (ticks overdue, tank index); reused between ticks
+	std::vector<std::pair<unsigned, std::size_t>> m_candidates;
+
+	sf::Time m_budget{ sf::Time::Zero };
+
+	// Running average of one look, in microseconds; 0 until the first report
+	float m_averageCost{ 0.0f };
+
+	unsigned m_deferred{ 0 };
+
+	// Tanks on screen and this close look every other tick
+	static constexpr float NEAR_RANGE = 600.0f;
+
+	// Tanks off screen and further than this look least often
+	static constexpr float FAR_RANGE = 1400.0f;
+
+	static constexpr unsigned NEAR_INTERVAL = 2;
+	static constexpr unsigned MID_INTERVAL = 4;
+	static constexpr unsigned FAR_INTERVAL = 8;
+
+	// A look deferred until the tank has waited this many intervals can't be deferred again
+	static constexpr unsigned MAX_INTERVALS_LATE = 2;
+
+	// Weight of the newest sample in the running average
+	static constexpr float COST_SMOOTHING = 0.1f;
+};
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <SFML/System/Vector2.hpp>
+
+/// <summary>
+/// @brief One tick's worth of player controls.
+/// 
+/// Filled from the keyboard and mouse by Game, or from an InputScript when
+/// running headless, so the simulation never has to poll a window itself.
+/// </summary>
+struct PlayerInput
+{
+	bool forward{ false };
+	bool back{ false };
+	bool left{ false };
+	bool right{ false };
+
+	// Set for the single tick on which the turret lock is toggled
+	bool toggleTurretFree{ false };
+
+	// World position the turret should aim at
+	sf::Vector2f aimPosition{ 0.0f,0.0f };
+};
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/// <summary>
+/// @brief Collects timings of named code sections into a lock-free ring buffer.
+/// 
+/// Sections are timed with PROFILE_SCOPE("name"), which times from that line to the end of the
+/// enclosing block. Scopes nest; each sample remembers how deep it was so reports can indent.
+/// Any thread may record. Writers claim a slot with a single atomic increment and never wait,
+/// so the oldest samples are simply overwritten once the buffer wraps.
+/// 
+/// Define PROFILER_DISABLED to compile every PROFILE_SCOPE out.
+/// </summary>
+class Profiler
+{
+public:
+	/// <summary>
+	/// @brief Timing statistics for one section over the samples currently held
+	/// </summary>
+	struct Summary
+	{
+		std::string name;
+		int depth{ 0 };
+		std::size_t count{ 0 };
+		double meanMs{ 0.0 };
+		double p99Ms{ 0.0 };
+		double maxMs{ 0.0 };
+	};
+
+	/// <summary>
+	/// @brief Times from construction to destruction, recording the result against a section
+	/// </summary>
+	class Scope
+	{
+	public:
+		Scope(int t_section);
+		~Scope();
+
+		Scope(Scope const&) = delete;
+		Scope& operator=(Scope const&) = delete;
+
+	private:
+		int m_section;
+		int m_depth;
+		std::chrono::steady_clock::time_point m_start;
+	};
+
+	// Number of samples held; a power of two so the write index can be masked
+	static const std::size_t CAPACITY = 1U << 16;
+
+	/// <summary>
+	/// @brief The profiler shared by the whole program
+	/// </summary>
+	static Profiler& get();
+
+	/// <summary>
+	/// @brief Gets the id for a section name, adding it if it's new
+	/// </summary>
+	int registerSection(const char* t_name);
+
+	/// <summary>
+	/// @brief Adds one sample to the ring buffer
+	/// </summary>
+	void record(int t_section, int t_depth, std::chrono::steady_clock::time_point t_start, std::chrono::steady_clock::duration t_duration);
+
+	/// <summary>
+	/// @brief Mean, 99th percentile and worst time for every section that has samples
+	/// </summary>
+	/// <returns>One summary per section, in the order the sections were first registered</returns>
+	std::vector<Summary> summarise() const;
+
+	/// <summary>
+	/// @brief Writes every held sample, one row each: section, depth, start and duration in microseconds
+	/// </summary>
+	void writeCsv(std::string const& t_path) const;
+
+	/// <summary>
+	/// @brief Writes the per-section summaries as a JSON array
+	/// </summary>
+	void writeJson(std::string const& t_path) const;
+
+private:
+	Profiler();
+
+	struct Sample
+	{
+		int section;
+		int depth;
+		std::int64_t startNs;
+		std::int64_t durationNs;
+	};
+
+	/// <summary>
+	/// @brief One ring buffer entry. The sequence number is written last, so a reader that sees
+	/// the same sequence before and after copying the fields knows it got a whole sample.
+	/// </summary>
+	struct Slot
+	{
+		std::atomic<std::uint64_t> sequence{ 0 };
+		std::atomic<int> section{ 0 };
+		std::atomic<int> depth{ 0 };
+		std::atomic<std::int64_t> startNs{ 0 };
+		std::atomic<std::int64_t> durationNs{ 0 };
+	};
+
+	/// <summary>
+	/// @brief Copies out every complete sample currently held
+	/// </summary>
+	std::vector<Sample> snapshot() const;
+
+	std::unique_ptr<Slot[]> m_slots;
+	std::atomic<std::uint64_t> m_nextWrite{ 0 };
+
+	std::chrono::steady_clock::time_point m_epoch;
+
+	// registration is rare (once per PROFILE_SCOPE line), so a plain lock is fine here
+	mutable std::mutex m_sectionMutex;
+	std::vector<std::string> m_sectionNames;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#ifdef PROFILER_DISABLED
+#define PROFILE_SCOPE(name)
+#else
+#define PROFILE_SCOPE(name) \
+	static const int PROFILE_CONCAT(profileSection_, __LINE__){ Profiler::get().registerSection(name) }; \
+	Profiler::Scope PROFILE_CONCAT(profileScope_, __LINE__){ PROFILE_CONCAT(profileSection_, __LINE__) }
+#endif
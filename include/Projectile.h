@@ -11,7 +11,7 @@ private:
 	Projectile()
     : 
 	m_active{ false },
-	m_timeToLive{ 0 }
+	m_timeToLive{ sf::Time::Zero }
 	{
 	};
 
@@ -24,7 +24,7 @@ private:
 	/// <param name="t_pos">initial position</param>
 	/// <param name="t_vel">initial velocity</param>
 	/// <param name="t_lifetime">lifetime of projectile</param>
-	void init(sf::Vector2f t_pos, sf::Vector2f t_vel, int t_timeToLive);
+	void init(sf::Vector2f t_pos, sf::Vector2f t_vel, sf::Time t_timeToLive);
 	
 	/// <summary>
 	/// @brief Update our position and time remaining
@@ -38,14 +38,19 @@ private:
 
 	bool m_active;
 
-	int m_timeToLive;
+	// simulation time left before the shell falls short
+	sf::Time m_timeToLive;
 
 	// pixels/second
 	float m_speed{ 250.0f };
 	float m_baseRotation{ 0.0f };
 
 	sf::Vector2f m_position{ 0.0f,0.0f };
+	sf::Vector2f m_previousPosition{ 0.0f,0.0f };
 	sf::Vector2f m_velocity{ 0.0f,0.0f };
 
+	// Handle of our proxy in the spatial grid, -1 if unregistered
+	int m_gridProxy{ -1 };
+
 	Projectile* m_next{ nullptr };
 };
\ No newline at end of file
@@ -3,9 +3,20 @@
 #include "Projectile.h"
 #include "CollisionDetector.h"
 #include "GameObject.h"
+#include "SpatialGrid.h"
 
 
-class TankAi;
+/// <summary>
+/// @brief A projectile striking something, reported back to the pool's owner rather than acted on
+/// </summary>
+struct ProjectileHit
+{
+	// where along its path the projectile struck
+	sf::Vector2f position;
+
+	// what it struck
+	GameObject* target;
+};
 
 class ProjectilePool
 {
@@ -14,6 +25,12 @@ public:
 
 	void setTexture(sf::Texture const& texture);
 
+	/// <summary>
+	/// @brief Uses the given grid to find collision candidates, and registers live projectiles with it on syncGrid()
+	/// </summary>
+	/// <param name="t_spatialGrid">grid shared with the rest of the game world</param>
+	void setSpatialGrid(SpatialGrid& t_spatialGrid);
+
 	/// <summary>
 	/// @brief Kill all active projectiles
 	/// </summary>
@@ -25,7 +42,7 @@ public:
 	/// <param name="t_pos">Position to put projectile</param>
 	/// <param name="t_vel">Velocity to give projectile</param>
 	/// <param name="t_timeToLive">Projectile lifespan</param>
-	void create(sf::Vector2f t_pos, sf::Vector2f t_vel, int t_timeToLive);
+	void create(sf::Vector2f t_pos, sf::Vector2f t_vel, sf::Time t_timeToLive);
 
 	/// <summary>
 	/// @brief Move all projectiles by their velocity
@@ -33,24 +50,25 @@ public:
 	void update(sf::Time dt);
 
 	/// <summary>
-	/// @brief returns the positions of all active projectiles
+	/// @brief Checks each active projectile against the objects sharing its grid cell.
+	/// Only reads the grid and never calls hit(), so pools can be checked from several threads at once
 	/// </summary>
-	/// <returns>A vector of sf::vector2fs, one pos per projectile</returns>
-	std::vector<sf::Vector2f> getActiveProjectilePos();
+	/// <param name="t_layers">SpatialGrid layers a projectile can hit</param>
+	/// <param name="t_hits">receives each hit, in pool order; the caller decides when to apply them</param>
+	void checkCollisions(unsigned t_layers, std::vector<ProjectileHit>& t_hits);
 
 	/// <summary>
-	/// 
+	/// @brief Brings the grid up to date with the projectiles created, moved and killed since the last sync.
+	/// The pool never writes to the grid anywhere else
 	/// </summary>
-	/// <param name="t_gameObjVector"></param>
-	/// <param name=""></param>
-	/// <param name="t_tank"></param>
-	void checkCollisions(std::vector<GameObject*>& t_gameObjVector, std::function<void(TankAi*, sf::Vector2f)>, TankAi* t_tank);
+	void syncGrid();
 
 	/// <summary>
 	/// @brief Iterate through our projectile array and draw them
 	/// </summary>
 	/// <param name="t_window">Reference to SF render window to draw to</param>
-	void render(sf::RenderWindow& t_window);
+	/// <param name="t_alpha">How far the frame is between the previous update (0) and the latest (1)</param>
+	void render(sf::RenderWindow& t_window, float t_alpha);
 
 private:
 
@@ -66,6 +84,14 @@ private:
 
 	Projectile* m_firstAvailable{ nullptr };
 
+	SpatialGrid* m_spatialGrid{ nullptr };
+
+	// Grid handles of projectiles killed since the last sync
+	std::vector<int> m_deadProxies;
+
+	// Reused between checks so collision queries don't allocate
+	std::vector<GameObject*> m_candidates;
+
 	const static int POOL_SIZE = 100;
 	Projectile m_projectiles[POOL_SIZE];
 };
\ No newline at end of file
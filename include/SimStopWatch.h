@@ -0,0 +1,57 @@
+#pragma once
+
+#include <SFML/System/Time.hpp>
+
+/// <summary>
+/// @brief A stopwatch driven by simulation time rather than the wall clock.
+/// 
+/// Mirrors the parts of thor::StopWatch we use, but only moves forward when its owner
+/// calls update() with the tick's delta time. Timers built on it behave the same whether
+/// the simulation is running at 60Hz in a window or flat out with no window at all.
+/// </summary>
+class SimStopWatch
+{
+public:
+	/// <summary>
+	/// @brief Creates a stopwatch with zero elapsed time
+	/// </summary>
+	/// <param name="t_running">Whether it starts running straight away (like sf::Clock) or stopped (like thor::StopWatch)</param>
+	SimStopWatch(bool t_running = false);
+
+	/// <summary>
+	/// @brief Advances the stopwatch, if it's running
+	/// </summary>
+	/// <param name="t_dt">Simulation time since the last update</param>
+	void update(sf::Time t_dt);
+
+	/// <summary>
+	/// @brief Simulation time accumulated while running
+	/// </summary>
+	inline sf::Time getElapsedTime() const { return m_elapsed; }
+
+	inline bool isRunning() const { return m_running; }
+
+	/// <summary>
+	/// @brief Resumes counting, keeping the elapsed time
+	/// </summary>
+	void start();
+
+	/// <summary>
+	/// @brief Pauses counting, keeping the elapsed time
+	/// </summary>
+	void stop();
+
+	/// <summary>
+	/// @brief Zeroes the elapsed time and stops
+	/// </summary>
+	void reset();
+
+	/// <summary>
+	/// @brief Zeroes the elapsed time and starts
+	/// </summary>
+	void restart();
+
+private:
+	sf::Time m_elapsed{ sf::Time::Zero };
+	bool m_running{ false };
+};
@@ -0,0 +1,274 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include <cmath>
+#include "CellResolution.h"
+#include "GameObject.h"
+#include "Obstacle.h"
+
+class Projectile;
+
+/// <summary>
+/// @brief Dense spatial partition of the world into CellResolution cells.
+///
+/// Static objects are stored CSR-style: m_cellStart[cell] .. m_cellStart[cell + 1]
+/// indexes into one packed array of object pointers, so a cell lookup is two array
+/// reads and walking it touches contiguous memory.
+///
+/// Moving objects (tanks, targets, projectiles) are registered as proxies. A proxy
+/// remembers the range of cells it covers and is only re-bucketed when that range changes.
+/// </summary>
+class SpatialGrid
+{
+public:
+	/// <summary>
+	/// @brief Bit flags used to filter queries by the kind of object
+	/// </summary>
+	enum Layer : unsigned
+	{
+		Obstacles = 1u << 0,
+		PlayerTank = 1u << 1,
+		EnemyTanks = 1u << 2,
+		Targets = 1u << 3,
+		Projectiles = 1u << 4,
+		AllLayers = 0xFFFFFFFFu
+	};
+
+	/// <summary>
+	/// @brief Non-owning view over the objects in a single cell
+	/// </summary>
+	struct ObjectSpan
+	{
+		GameObject* const* first{ nullptr };
+		GameObject* const* last{ nullptr };
+
+		GameObject* const* begin() const { return first; }
+		GameObject* const* end() const { return last; }
+		std::size_t size() const { return static_cast<std::size_t>(last - first); }
+		bool empty() const { return first == last; }
+	};
+
+	/// <summary>
+	/// @brief The circle an AI tank steers around for one obstacle, worked out once when the grid is built
+	/// </summary>
+	struct CircleCollider
+	{
+		sf::Vector2f centre;
+		float radius;
+	};
+
+	SpatialGrid();
+
+	/// <summary>
+	/// @brief Buckets every obstacle into each cell its bounds overlap. Replaces any previous obstacles.
+	/// </summary>
+	/// <param name="t_obstacles">obstacles to insert; must outlive the grid contents</param>
+	void build(std::vector<Obstacle>& t_obstacles);
+
+	/// <summary>
+	/// @brief Returns the obstacles occupying a cell, without allocating
+	/// </summary>
+	/// <param name="t_gridRef">grid reference from CellResolution::getGridRef</param>
+	/// <returns>Span of objects, empty if the cell is out of bounds or unoccupied</returns>
+	ObjectSpan getCell(int t_gridRef) const;
+
+	/// <summary>
+	/// @brief Returns the avoidance circles of the obstacles occupying a cell, in the same order as getCell()
+	/// </summary>
+	/// <param name="t_gridRef">grid reference from CellResolution::getGridRef</param>
+	/// <returns>Pointer to getCell(t_gridRef).size() colliders, nullptr if the cell is out of bounds or unoccupied</returns>
+	CircleCollider const* getCellColliders(int t_gridRef) const;
+
+	/// <summary>
+	/// @brief Removes all obstacles from the grid. Registered proxies are unaffected.
+	/// </summary>
+	void clear();
+
+	/// <summary>
+	/// @brief Registers a moving game object with the grid
+	/// </summary>
+	/// <param name="t_object">object to track</param>
+	/// <param name="t_layer">layer the object is found on by queries</param>
+	/// <param name="t_bounds">world space bounds of the object</param>
+	/// <returns>Handle used to update or remove the proxy</returns>
+	int insert(GameObject* t_object, Layer t_layer, sf::FloatRect const& t_bounds);
+
+	/// <summary>
+	/// @brief Registers a projectile with the grid as a point
+	/// </summary>
+	/// <param name="t_projectile">projectile to track</param>
+	/// <param name="t_position">current position of the projectile</param>
+	/// <returns>Handle used to update or remove the proxy</returns>
+	int insert(Projectile const* t_projectile, sf::Vector2f t_position);
+
+	/// <summary>
+	/// @brief Updates the bounds of a proxy, re-bucketing it only if it moved into different cells
+	/// </summary>
+	/// <param name="t_proxy">handle returned by insert</param>
+	/// <param name="t_bounds">new world space bounds</param>
+	void update(int t_proxy, sf::FloatRect const& t_bounds);
+
+	/// <summary>
+	/// @brief Point overload of update, for projectiles
+	/// </summary>
+	void update(int t_proxy, sf::Vector2f t_position);
+
+	/// <summary>
+	/// @brief Unregisters a proxy. The handle may be handed out again by a later insert.
+	/// </summary>
+	/// <param name="t_proxy">handle returned by insert</param>
+	void remove(int t_proxy);
+
+	/// <summary>
+	/// @brief Finds all objects whose bounds intersect a rectangle
+	/// </summary>
+	/// <param name="t_area">world space rectangle</param>
+	/// <param name="t_layers">bitwise OR of the layers to search</param>
+	/// <param name="t_results">cleared, then filled with each matching object once</param>
+	void queryAABB(sf::FloatRect const& t_area, unsigned t_layers, std::vector<GameObject*>& t_results) const;
+
+	/// <summary>
+	/// @brief Finds all objects whose bounds come within a radius of a point
+	/// </summary>
+	/// <param name="t_centre">centre of the search circle</param>
+	/// <param name="t_radius">radius of the search circle</param>
+	/// <param name="t_layers">bitwise OR of the layers to search</param>
+	/// <param name="t_results">cleared, then filled with each matching object once</param>
+	void queryRadius(sf::Vector2f t_centre, float t_radius, unsigned t_layers, std::vector<GameObject*>& t_results) const;
+
+	/// <summary>
+	/// @brief Finds all objects whose bounds overlap a sector (a vision cone), visiting only the cells under the sector's bounding box.
+	/// May also return a few objects just outside the curved edge, never misses one inside
+	/// </summary>
+	/// <param name="t_origin">tip of the sector</param>
+	/// <param name="t_heading">direction the sector faces, need not be normalised</param>
+	/// <param name="t_halfAngle">angle between the heading and either straight edge, in radians</param>
+	/// <param name="t_range">radius of the sector</param>
+	/// <param name="t_layers">bitwise OR of the layers to search</param>
+	/// <param name="t_results">cleared, then filled with each matching object once</param>
+	void querySector(sf::Vector2f t_origin, sf::Vector2f t_heading, float t_halfAngle, float t_range, unsigned t_layers, std::vector<GameObject*>& t_results) const;
+
+	/// <summary>
+	/// @brief Finds all registered projectiles inside a rectangle
+	/// </summary>
+	/// <param name="t_area">world space rectangle</param>
+	/// <param name="t_results">cleared, then filled with each projectile once</param>
+	void queryProjectiles(sf::FloatRect const& t_area, std::vector<Projectile const*>& t_results) const;
+
+	/// <summary>
+	/// @brief Removes duplicates left by objects that span more than one cell.
+	/// Keeps the first copy of each, so the order objects were gathered in is preserved
+	/// </summary>
+	/// <param name="t_results">objects gathered cell by cell</param>
+	static void removeDuplicates(std::vector<GameObject*>& t_results);
+
+private:
+
+	/// <summary>
+	/// @brief A moving object tracked by the grid
+	/// </summary>
+	struct Proxy
+	{
+		GameObject* object{ nullptr };
+		Projectile const* projectile{ nullptr };
+		unsigned layer{ 0u };
+		sf::FloatRect bounds;
+		sf::Vector2i minCell{ 0, 0 };
+		sf::Vector2i maxCell{ -1, -1 };
+	};
+
+	/// <summary>
+	/// @brief Finds the range of cells overlapped by an axis aligned rectangle
+	/// </summary>
+	/// <param name="t_bounds">rectangle in world space</param>
+	/// <param name="t_min">top-left cell column/row</param>
+	/// <param name="t_max">bottom-right cell column/row</param>
+	static void getCellRange(sf::FloatRect const& t_bounds, sf::Vector2i& t_min, sf::Vector2i& t_max);
+
+	/// <summary>
+	/// @brief Adds or removes a proxy handle from every cell in the given range
+	/// </summary>
+	void linkProxy(int t_proxy, sf::Vector2i t_min, sf::Vector2i t_max);
+	void unlinkProxy(int t_proxy, sf::Vector2i t_min, sf::Vector2i t_max);
+
+	/// <summary>
+	/// @brief Collects candidates from every cell in a range whose bounds pass the given test
+	/// </summary>
+	template <typename Test>
+	void gatherCells(sf::FloatRect const& t_area, unsigned t_layers, Test&& t_test, std::vector<GameObject*>& t_results) const;
+
+	/// <summary>
+	/// @brief Collects candidates from a single cell whose bounds pass the given test
+	/// </summary>
+	template <typename Test>
+	void gatherCell(int t_gridRef, unsigned t_layers, Test& t_test, std::vector<GameObject*>& t_results) const;
+
+	// Start offset of each cell in m_cellObjects, one extra entry marks the end of the last cell
+	std::vector<int> m_cellStart;
+
+	// Packed object pointers, grouped by cell
+	std::vector<GameObject*> m_cellObjects;
+
+	// World bounds of each entry in m_cellObjects
+	std::vector<sf::FloatRect> m_cellBounds;
+
+	// Avoidance circle of each entry in m_cellObjects
+	std::vector<CircleCollider> m_cellColliders;
+
+	// Avoidance circles are this many times the width of the obstacle's sprite
+	static constexpr float COLLIDER_SCALE = 1.5f;
+
+	// Proxy handles registered in each cell
+	std::vector<std::vector<int>> m_dynamicCells;
+
+	// All proxies, indexed by handle
+	std::vector<Proxy> m_proxies;
+
+	// Handles of removed proxies, ready for reuse
+	std::vector<int> m_freeProxies;
+};
+
+////////////////////////////////////////////////////////////
+
+template <typename Test>
+void SpatialGrid::gatherCells(sf::FloatRect const& t_area, unsigned t_layers, Test&& t_test, std::vector<GameObject*>& t_results) const
+{
+	t_results.clear();
+
+	sf::Vector2i minCell, maxCell;
+	getCellRange(t_area, minCell, maxCell);
+
+	for (int col = minCell.x; col <= maxCell.x; col++)
+	{
+		for (int row = minCell.y; row <= maxCell.y; row++)
+		{
+			gatherCell(CellResolution::getGridRef(col, row), t_layers, t_test, t_results);
+		}
+	}
+
+	removeDuplicates(t_results);
+}
+
+////////////////////////////////////////////////////////////
+
+template <typename Test>
+void SpatialGrid::gatherCell(int t_gridRef, unsigned t_layers, Test& t_test, std::vector<GameObject*>& t_results) const
+{
+	if (t_layers & Obstacles)
+	{
+		for (int i = m_cellStart[t_gridRef]; i < m_cellStart[t_gridRef + 1]; i++)
+		{
+			if (t_test(m_cellBounds[i])) t_results.push_back(m_cellObjects[i]);
+		}
+	}
+
+	for (int handle : m_dynamicCells[t_gridRef])
+	{
+		Proxy const& proxy{ m_proxies[handle] };
+
+		if ((proxy.layer & t_layers) && proxy.object && t_test(proxy.bounds))
+		{
+			t_results.push_back(proxy.object);
+		}
+	}
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+
+/// <summary>
+/// @brief Where a sprite was at the end of the previous simulation step.
+/// 
+/// The simulation runs at a fixed rate that rarely matches the display, so each frame lands
+/// somewhere between two steps. Entities capture their sprites here before every step, and
+/// rendering draws a copy placed between this state and the sprite's current one.
+/// </summary>
+struct SpriteState
+{
+	sf::Vector2f position{ 0.0f,0.0f };
+	float rotation{ 0.0f };
+
+	/// <summary>
+	/// @brief Remembers the sprite's current position and rotation
+	/// </summary>
+	void capture(sf::Sprite const& t_sprite);
+
+	/// <summary>
+	/// @brief Copies the sprite and places the copy between this state and the sprite's own
+	/// </summary>
+	/// <param name="t_current">Sprite as of the latest simulation step</param>
+	/// <param name="t_alpha">How far the frame is from the previous step (0) to the latest one (1)</param>
+	/// <returns>The sprite to draw this frame</returns>
+	sf::Sprite blend(sf::Sprite const& t_current, float t_alpha) const;
+
+	/// <summary>
+	/// @brief Just the blended position, for things that follow an entity (the camera, its vision cone)
+	/// </summary>
+	sf::Vector2f blendPosition(sf::Sprite const& t_current, float t_alpha) const;
+};
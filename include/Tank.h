@@ -2,17 +2,21 @@
 #define DEBUG
 
 #include <SFML/Graphics.hpp>
+#include <random>
 #include <Thor/Math.hpp>
 #include <Thor/Time.hpp>
-#include <Thor/Particles.hpp>
-#include <Thor/Animations.hpp>
 
 #include "CollisionDetector.h"
 #include "CellResolution.h"
+#include "SpatialGrid.h"
 
 #include "GameState.h"
 #include "GameObject.h"
+#include "GameEvent.h"
+#include "SimStopWatch.h"
+#include "SpriteState.h"
 #include "TankDamage.h"
+#include "ParticleManager.h"
 
 #include "Obstacle.h"
 #include "Target.h"
@@ -34,12 +38,16 @@ public:
 /// Creates sprites for the tank base and turret from the supplied texture.
 /// </summary>
 /// <param name="texture">A reference to the sprite sheet texture</param>
-///< param name="texture">A reference to the container of wall sprites</param>
+///< param name="t_spatialGrid">A reference to the spatial grid holding walls, targets and tanks</param>
+///< param name="t_events">Queue to report hits on</param>
+///< param name="t_particles">The world's particles, where our smoke and sparks go</param>
+///< param name="t_random">The match's random number stream</param>
 	Tank(sf::Texture const & t_texture, 
-		std::map<int, std::list<GameObject*>>& t_obstacleMap, 
-		std::vector<Target>& t_targetVector,
-		TankAi& t_enemyTank,
-		float& t_screenShake);
+		SpatialGrid& t_spatialGrid, 
+		float& t_screenShake,
+		EventQueue& t_events,
+		ParticleManager& t_particles,
+		std::mt19937& t_random);
 
 	inline sf::Vector2f position() const { return m_tankBase.getPosition(); }
 
@@ -55,24 +63,28 @@ public:
 	void setPosition(sf::Vector2f const& m_pos);
 
 	/// <summary>
-	/// @brief Increases the speed by 1, max speed is capped at 100.
+	/// @brief Accelerates for one step, max speed is capped at 100.
 	/// </summary>
-	void increaseSpeed();
+	/// <param name="t_dt">Length of the step</param>
+	void increaseSpeed(sf::Time t_dt);
 
 	/// <summary>
-	/// @brief Decreases the speed by 1, min speed is capped at -100.
+	/// @brief Decelerates for one step, min speed is capped at -100.
 	/// </summary>
-	void decreaseSpeed();
+	/// <param name="t_dt">Length of the step</param>
+	void decreaseSpeed(sf::Time t_dt);
 
 	/// <summary>
-	/// @brief Increases the rotation by 1 degree, wraps to 0 degrees after 359.
+	/// @brief Turns clockwise for one step, wraps to 0 degrees after 359.
 	/// </summary>
-	void increaseRotation();
+	/// <param name="t_dt">Length of the step</param>
+	void increaseRotation(sf::Time t_dt);
 
 	/// <summary>
-	/// @brief Decreases the rotation by 1 degree, wraps to 359 degrees after 0.
+	/// @brief Turns anticlockwise for one step, wraps to 359 degrees after 0.
 	/// </summary>
-	void decreaseRotation();
+	/// <param name="t_dt">Length of the step</param>
+	void decreaseRotation(sf::Time t_dt);
 
 	/// <summary>
 	/// @brief Sets the absolute rotation of the turret.
@@ -96,6 +108,18 @@ public:
 	/// <returns>SF::Sprite object for tank base</returns>
 	inline sf::Sprite const getBase() const { return m_tankBase; }
 
+	/// <summary>
+	/// @brief Get the cached bounding box of the tank base
+	/// </summary>
+	/// <returns>Oriented box, only recalculated after the base moves or turns</returns>
+	inline OrientedBoundingBox const& getBaseBoundingBox() const { m_boundingBox.Refresh(m_tankBase); return m_boundingBox; }
+
+	/// <summary>
+	/// @brief Get the cached bounding box of the tank turret
+	/// </summary>
+	/// <returns>Oriented box, only recalculated after the turret moves or turns</returns>
+	inline OrientedBoundingBox const& getTurretBoundingBox() const { m_turretBoundingBox.Refresh(m_turret); return m_turretBoundingBox; }
+
 	/// <summary>
 	/// @brief Get the players health value
 	/// </summary>
@@ -120,7 +144,18 @@ public:
 	sf::Sprite& getSprite() override { return m_tankBase; }
 
 	void update(sf::Time dt);
-	void render(sf::RenderWindow & window);
+
+	/// <summary>
+	/// @brief Draws the tank between where it was last step and where it is now
+	/// </summary>
+	/// <param name="window">The SFML Render window</param>
+	/// <param name="t_alpha">How far the frame is between the previous simulation step (0) and the latest (1)</param>
+	void render(sf::RenderWindow & window, float t_alpha);
+
+	/// <summary>
+	/// @brief Where the tank is drawn this frame, for the camera to follow
+	/// </summary>
+	inline sf::Vector2f getRenderPosition(float t_alpha) const { return m_lastBaseState.blendPosition(m_tankBase, t_alpha); }
 	
 private:
 
@@ -163,15 +198,20 @@ private:
 	void initSprites();
 
 	/// <summary>
-	/// @brief Loads particle textures from file
+	/// @brief Adds our smoke and track spark emitters to the world's particles
 	/// </summary>
-	void loadParticleTextures();
+	void initParticles();
 
 	/// <summary>
 	/// @brief Updates the game objects that are in our current grid space (spacially partitioned)
 	/// </summary>
 	void updateGameObjects();
 
+	/// <summary>
+	/// @brief Bounds covering both our base and turret
+	/// </summary>
+	sf::FloatRect getFootprint() const;
+
 
 	// ####### SPRITES AND TEXTURES #######
 
@@ -179,36 +219,41 @@ private:
 	sf::Sprite m_turret;
 	sf::Texture const & m_texture;
 
-	// A reference to the container of wall sprites.
-	std::map<int, std::list<GameObject*>>& ref_obstacles;
+	// Cached collision box for the turret, the base uses GameObject::m_boundingBox
+	mutable OrientedBoundingBox m_turretBoundingBox;
+
+	// A reference to the spatial partition of walls, targets and tanks.
+	SpatialGrid& ref_spatialGrid;
+	int m_gridProxy{ -1 };
+
+	// Walls in the cells we occupy
 	std::vector<GameObject*> m_obstacles;
 
-	// A reference to the container of target sprites.
-	std::vector<Target>& ref_targets;
+	// Corners of m_obstacles in batch form, and which of them we hit last check
+	OrientedBoundingBoxBatch m_obstacleBoxes;
+	std::vector<std::uint32_t> m_wallHits;
+
+	// Targets overlapping our footprint
 	std::vector<GameObject*> m_targets;
 
-	// A reference to the container of enemy tanks
-	TankAi& ref_enemyTank;
+	// Enemy tanks overlapping our footprint
 	std::vector<GameObject*> m_enemyTanks;
 
 	// ####################################
 
 
 
-	// ########## THOR PARTICLES ##########
-
-	void updateParticles(sf::Time t_dt);
+	// ########## PARTICLES ##########
 
-	sf::Texture m_smokeTexture;
-	sf::Texture m_sparkTexture;
+	void updateParticles();
 
+	// Number of hits taken, up to 10, each adding SMOKE_PER_HIT to the smoke's emission rate
 	int m_smokeEmissionRate{ 0 };
+	static constexpr float SMOKE_PER_HIT = 30.0f;
 
-	thor::ParticleSystem m_smokeParticleSystem;
-	thor::ParticleSystem m_sparkParticleSystem;
-
-	thor::UniversalEmitter m_sparksEmitter = thor::UniversalEmitter();
-	thor::UniversalEmitter m_smokeEmitter = thor::UniversalEmitter();
+	ParticleManager::EmitterHandle m_smokeEmitter{};
+	ParticleManager::EmitterHandle m_leftTrackSparks{};
+	ParticleManager::EmitterHandle m_rightTrackSparks{};
 
 	// ####################################
 
@@ -221,7 +266,7 @@ private:
 	TankDamage m_damageLevels;
 
 	// How long have we been damaged for?
-	thor::StopWatch m_damageClock;
+	SimStopWatch m_damageClock;
 	// How long should we be damaged for before it's repaired?
 	sf::Time m_damageTime{ sf::seconds(7.5f) };
 
@@ -229,7 +274,9 @@ private:
 	
 	static constexpr float M_MAX_SPEED = 100.0f;
 	static constexpr float M_MIN_SPEED = -100.0f;
-	static constexpr float M_FRICTION = 0.2f;
+	static constexpr float M_FRICTION = 12.0f; // speed lost per second when coasting
+	static constexpr float M_ACCELERATION = 36.0f; // speed gained per second of throttle
+	static constexpr float M_TURN_RATE = 60.0f; // degrees per second with both tracks intact
 
 	const float MAX_HEALTH{ 100.0f };
 	float m_health{MAX_HEALTH};
@@ -257,17 +304,34 @@ private:
 
 	// rolling storage of our last position
 	sf::Vector2f m_previousPosition{ 0.0f,0.0f };
+
+	// base and turret as of the previous simulation step, for render interpolation
+	SpriteState m_lastBaseState;
+	SpriteState m_lastTurretState;
 	
 	// rolling storage of our last speed
 	float m_previousSpeed;
 
-	std::set<int> m_activeCells;
+	// Cells we currently occupy (sorted, no duplicates)
+	std::vector<int> m_activeCells;
+
+	// Cells worked out this update, swapped into m_activeCells only if they differ
+	std::vector<int> m_nextCells;
 
 	// ####################################
 
 	// Linked to the game trauma variable, controls amount of screenshake
 	float& m_screenShake;
 
+	// Where we report being hit
+	EventQueue& ref_events;
+
+	// The world's particles; our emitters live there
+	ParticleManager& ref_particles;
+
+	// Per-match random stream, so concurrent matches don't share rand()'s global state
+	std::mt19937& ref_random;
+
 	// ############# DEBUGGING ############
 
 	sf::RectangleShape temp_activeCellRect;
@@ -4,17 +4,18 @@
 #include "MathUtility.h"
 #include "Tank.h"
 #include <SFML/Graphics.hpp>
-#include <SFML/Audio.hpp>
 #include <Thor/Vectors.hpp>
-#include <Thor/Particles.hpp>
-#include <Thor/Animations.hpp>
 #include <Thor/Time.hpp>
 
 #include "GameState.h"
+#include "GameEvent.h"
+#include "SimStopWatch.h"
+#include "SpriteState.h"
 #include "ProjectilePool.h"
+#include "FlowField.h"
+#include "NavMesh.h"
 #include <iostream>
 #include <queue>
-#include <thread>
 
 class TankAi : public GameObject
 {
@@ -25,14 +26,13 @@ public:
 	///  initialises the steering vector to (0,0) meaning zero force magnitude.
 	/// </summary>
 	/// <param name="texture">A reference to the sprite sheet texture</param>
-	///< param name="wallSprites">A reference to the container of wall sprites</param>
-	TankAi(sf::Texture const & texture, std::map<int, std::list<GameObject*>>& t_obstacleMap, std::vector<Obstacle>& t_obstacleVector, float& t_screenShake);
-
-	/// <summary>
-	/// @brief Passes in audio to the AI tank
-	/// </summary>
-	/// <param name="t_firingSFXbuffer">A reference to the soundbuffer</param>
-	inline void setAudio(sf::SoundBuffer& t_firingSFXbuffer, sf::SoundBuffer& t_shellImpact) { m_firingSound.setBuffer(t_firingSFXbuffer), m_impactSound.setBuffer(t_shellImpact); }
+	///< param name="t_spatialGrid">A reference to the spatial grid holding walls and tanks</param>
+	///< param name="t_flowField">Directions to the player, shared by every tank chasing them</param>
+	///< param name="t_navMesh">The open ground between the rocks, for planning patrol routes</param>
+	///< param name="t_events">Queue to report firing, impacts and hits on</param>
+	///< param name="t_particles">The world's particles, where our muzzle flashes and impact smoke go</param>
+	///< param name="t_random">The match's random number stream, used once to seed this tank's own</param>
+	TankAi(sf::Texture const & texture, SpatialGrid& t_spatialGrid, FlowField const& t_flowField, NavMesh const& t_navMesh, float& t_screenShake, EventQueue& t_events, ParticleManager& t_particles, std::mt19937& t_random);
 
 	/// <summary>
 	/// @brief Steers the AI tank towards the player tank avoiding obstacles along the way.
@@ -41,11 +41,33 @@ public:
 	/// is set to 0. Then compute the correct rotation angle to point towards the player tank. 
 	/// If the distance to the player tank is < MAX_SEE_AHEAD, then the behaviour is changed from seek to stop.
 	/// Finally, recalculate the new position of the tank base and turret sprites.
+	///
+	/// Only writes to this tank; anything that touches shared state (screenshake, events, hits,
+	/// the spatial grid) is held back until commit(), so tanks can be updated concurrently.
 	/// </summary>
-	/// <param name="playerTank">A reference to the player tank</param>
+	/// <param name="playerTank">A reference to the player tank, only read</param>
 	/// <param name="dt">update delta time</param>
 	void update(Tank & playerTank, sf::Time dt);
 
+	/// <summary>
+	/// @brief Applies what the last update held back: screenshake, events, hits on other objects,
+	/// our grid entries and particle effects. Tanks must be committed one at a time, in a fixed order
+	/// </summary>
+	void commit();
+
+	/// <summary>
+	/// @brief Sets whether the next update refreshes our vision cone and nearby obstacles,
+	/// or keeps acting on what we last saw
+	/// </summary>
+	inline void setPerceiving(bool t_perceiving) { m_perceiving = t_perceiving; }
+
+	inline bool isPerceiving() const { return m_perceiving; }
+
+	/// <summary>
+	/// @brief How long the last update's look around took, zero if it didn't look
+	/// </summary>
+	inline sf::Time getPerceptionCost() const { return m_perceptionCost; }
+
 	/// <summary>
 	/// @brief Tells our AI tank in which area it should patrol
 	/// </summary>
@@ -59,6 +81,18 @@ public:
 	/// <returns>True if collision detected between AI and player tanks.</returns>
 	bool collidesWithPlayer(Tank const& playerTank) const;
 
+	/// <summary>
+	/// @brief Get the cached bounding box of the tank base
+	/// </summary>
+	/// <returns>Oriented box, only recalculated after the base moves or turns</returns>
+	inline OrientedBoundingBox const& getBaseBoundingBox() const { m_boundingBox.Refresh(m_tankBase); return m_boundingBox; }
+
+	/// <summary>
+	/// @brief Get the cached bounding box of the tank turret
+	/// </summary>
+	/// <returns>Oriented box, only recalculated after the turret moves or turns</returns>
+	inline OrientedBoundingBox const& getTurretBoundingBox() const { m_turretBoundingBox.Refresh(m_turret); return m_turretBoundingBox; }
+
 	/// <summary>
 	/// @brief Returns a reference to our base sprite
 	/// </summary>
@@ -73,7 +107,8 @@ public:
 	/// @brief Draws the tank base and turret.
 	/// </summary>
 	/// <param name="window">The SFML Render window</param>
-	void render(sf::RenderWindow & window);
+	/// <param name="t_alpha">How far the frame is between the previous simulation step (0) and the latest (1)</param>
+	void render(sf::RenderWindow & window, float t_alpha);
 
 	/// <summary>
 	/// @brief Sets the tank base/turret sprites to the specified position.
@@ -128,10 +163,21 @@ private:
 	void driveTo(sf::Vector2f t_playerPos);
 
 	/// <summary>
-	/// @brief Randomly select a new target on-screen for our patrol
+	/// @brief Which way to drive to reach the player: along the flow field round the rocks,
+	/// or straight at them once we're on their tile or the field has no way through
+	/// </summary>
+	sf::Vector2f routeToPlayer() const;
+
+	/// <summary>
+	/// @brief Randomly select a new target in our patrol zone that we can drive to, and plan the route there
 	/// </summary>
 	void choosePatrolTarget();
 
+	/// <summary>
+	/// @brief The next corner of our patrol route, moving on to the one after once we're close
+	/// </summary>
+	sf::Vector2f nextPatrolWaypoint();
+
 	/// <summary>
 	/// @brief Updates the position of the vision cone
 	/// </summary>
@@ -143,9 +189,9 @@ private:
 	void updateVisionColor();
 
 	/// <summary>
-	/// @brief Given a position, this function returns whether or not it's in our vision cone
+	/// @brief Collects the obstacles overlapping our vision cone, from the grid cells under it
 	/// </summary>
-	bool inCone(sf::Vector2f t_pos);
+	void gatherOccluders();
 
 	/// <summary>
 	/// @brief Determines the angle between ray casts given their magnitude and arc length
@@ -172,17 +218,22 @@ private:
 	sf::Vector2f collisionAvoidance();
 
 	/// <summary>
-	/// @brief Identifies which obstacle is the most immediate threat to us (I.e., we're about to hit it)
+	/// @brief Identifies which obstacle is the most immediate threat to us: the nearest one our look-ahead reaches into
 	/// </summary>
-	/// <returns>Bounding circle of the obstacle</returns>
-	const sf::CircleShape findMostThreateningObstacle();
+	/// <returns>Index into m_obstacleColliders, or -1 if nothing is in our way</returns>
+	int findMostThreateningObstacle() const;
 
 	/// <summary>
 	/// @brief Updates which game objects are in our local area (spatial partitioning code)
 	/// </summary>
 	void updateGameObjects();
 
-	// ########### THOR VFX ############
+	/// <summary>
+	/// @brief Bounds covering both our base and turret
+	/// </summary>
+	sf::FloatRect getFootprint() const;
+
+	// ######### PARTICLE EFFECTS #########
 
 	/// <summary>
 	/// @brief Handles turret firing effects
@@ -196,60 +247,39 @@ private:
 	void projectileImpact(sf::Vector2f t_impactPos);
 
 	/// <summary>
-	/// @brief Alias for projectileImpact function
-	/// </summary>
-	std::function<void(TankAi*, sf::Vector2f)> f_projectileImpact;
-
-	/// <summary>
-	/// 
+	/// @brief Adds a burst of smoke to our impact particle system
 	/// </summary>
-	/// <param name="t_impactPos"></param>
+	/// <param name="t_impactPos">location of impact</param>
 	void impactSmoke(sf::Vector2f t_impactPos);
 
 	/// <summary>
-	/// @brief Alias for impactSmoke function
+	/// @brief Starts the smoke for every impact queued since the last call, just before the particles update
 	/// </summary>
-	std::function<void(TankAi*, sf::Vector2f)> f_impactSmoke;
+	void spawnPendingEffects();
+
 
 	/// <summary>
-	/// @brief I want a more lightweight version of an SF::CircleShape with
-	/// public data and no drawing functionality, for quick collision checks
+	/// @brief Side effects of one update on shared state, held back until commit()
 	/// </summary>
-	struct CircleBounds
+	struct Commands
 	{
-		CircleBounds(sf::Vector2f t_pos, float t_radius) : 
-			position{ t_pos }, radius{ t_radius } {}
+		// did we fire this update, from where and which way
+		bool fired{ false };
+		sf::Vector2f firePosition;
+		sf::Vector2f fireDirection;
 
-		sf::Vector2f position;
-		float radius;
+		// what our shells struck, in the order they struck it
+		std::vector<ProjectileHit> hits;
 	};
 
+	Commands m_commands;
 
-	// ############# THREADS ##############
-
-	std::thread* m_smokeThread;
-
-	// ####################################
-
-
-	// ########## THOR PARTICLES ##########
+	// Impacts waiting for their smoke. Effects are only ever fired from commit(), as the world's
+	// particles are shared by every tank
+	std::vector<sf::Vector2f> m_pendingImpactSmoke;
 
-	sf::Texture m_smokeTexture;
-	sf::Texture m_sparkTexture;
-
-	thor::ParticleSystem m_smokeParticleSystem;
-	thor::ParticleSystem m_sparkParticleSystem;
-
-	thor::UniversalEmitter m_sparksEmitter = thor::UniversalEmitter();
-	thor::UniversalEmitter m_smokeEmitter = thor::UniversalEmitter();
-
-	thor::ParticleSystem m_impactParticleSystem;
-	thor::UniversalEmitter m_impactSmokeEmitter;
-
-	// ####################################
-
-	// Cells we should check for collisions in
-	std::set<int> m_activeCells;
+	// Cells we should check for collisions in (sorted, no duplicates)
+	std::vector<int> m_activeCells;
 
 	// A reference to the sprite sheet texture.
 	sf::Texture const & m_texture;
@@ -260,28 +290,43 @@ private:
 	// A sprite for the turret
 	sf::Sprite m_turret;
 
+	// Cached collision box for the turret, the base uses GameObject::m_boundingBox
+	mutable OrientedBoundingBox m_turretBoundingBox;
+
+	// base and turret as of the previous simulation step, for render interpolation
+	SpriteState m_lastBaseState;
+	SpriteState m_lastTurretState;
+
 	// Used for screenshake effect when firing
 	float& m_screenShake;
 
-	// Cannon firing SFX
-	sf::Sound m_firingSound;
-	sf::Sound m_impactSound;
+	// Where we report firing, impacts and hits (sound is played by whoever drains it)
+	EventQueue& ref_events;
+
+	// The world's particles
+	ParticleManager& ref_particles;
+
+	// Our own random stream for picking patrol targets, seeded from the match's at construction
+	// so tanks updating concurrently never share one
+	std::mt19937 m_random;
 
 	// Projectile pool for firing
 	ProjectilePool m_projectilePool;
 
 	// ######### OBSTACLE TRACKING ##########
 
-	// A reference to the container of wall sprites.
-	std::map<int, std::list<GameObject*>>& ref_obstacleMap;
+	// A reference to the spatial partition of walls and tanks.
+	SpatialGrid& ref_spatialGrid;
+	int m_gridProxy{ -1 };
 
-	// A container of circles that represent the obstacles to avoid.
-	std::vector<sf::CircleShape> m_obstacleColliders;
-	std::vector<GameObject*> m_obstaclesInPartition;
+	// Shared directions to the player, kept up to date by GameWorld while anyone is following them
+	FlowField const& ref_flowField;
 
-	// We use these for calculating vision cone occlusion
-	std::vector<Obstacle>& ref_obstacleVector;
-	std::vector<CircleBounds> m_obstaclesInCone;
+	// The open ground, for routes to our patrol targets
+	NavMesh const& ref_navMesh;
+
+	// A container of circles that represent the obstacles to avoid.
+	std::vector<SpatialGrid::CircleCollider> m_obstacleColliders;
 
 	// ######################################
 
@@ -289,10 +334,24 @@ private:
 
 	sf::Vector2f vectorToPlayer{ 0.0f,0.0f };
 
-	sf::FloatRect m_playerTankRect;
+	// The player's box as of our last look; rays that reach it before an obstacle have seen the player
+	OrientedBoundingBox m_playerBox;
+
+	// Whether the next update looks around, and how long the last look took
+	bool m_perceiving{ true };
+	sf::Time m_perceptionCost;
+
+	// Where the vision cone was built from, which can be a few updates ago
+	sf::Vector2f m_visionOrigin;
+
+	// Our vision rays, cast against every occluder at once
+	RayFan m_visionRays;
+
+	// Obstacles overlapping our vision cone, reused between updates
+	std::vector<GameObject*> m_occluders;
 
 	// Restarts every time the player is seen
-	thor::StopWatch m_playerLastSeen;
+	SimStopWatch m_playerLastSeen;
 
 	// If the player hasn't been seen in this time period, our AI tank will resume patrolling the map
 	sf::Time m_timeToLosePlayer{ sf::seconds(2.0f) };
@@ -310,6 +369,16 @@ private:
 	// A collider for our nav target
 	sf::CircleShape m_patrolTargetBounds{ 20.0f };
 
+	// Corners to drive through on the way to our patrol target, ending with the target itself
+	std::vector<sf::Vector2f> m_patrolPath;
+	std::size_t m_patrolWaypoint{ 0 };
+
+	// How close we get to a corner before heading for the next one
+	static constexpr float WAYPOINT_RADIUS = 30.0f;
+
+	// Random picks per new patrol target before we settle for one we can't plan a route to
+	static constexpr int MAX_PATROL_PICKS = 8;
+
 	// ######################################
 
 	// The current rotation in degrees as applied to tank base.
@@ -322,9 +391,12 @@ private:
 	const float TURN_RATE{ 0.1f };
 
 	// Throttle the tank's fire rate to one shot per delay time
-	sf::Clock m_fireClock;
+	SimStopWatch m_fireClock{ true };
 	sf::Time m_fireDelay{ sf::seconds(2.0f) };
 
+	// How long a shell flies before falling short
+	const sf::Time SHELL_LIFETIME{ sf::seconds(4.0f) };
+
 	const float MASS{ 4.0f };
 
 	// Current velocity.
@@ -362,11 +434,13 @@ private:
 
 	float m_visionConeRotation;
 
+	// How fast the cone sweeps while patrolling, degrees per second
+	static constexpr float VISION_SWEEP_RATE = 60.0f;
+
 	// Angle between each ray
 	float m_arcPerRay;
 
-	// Distance between distal ends of ray casts; vision arc will reduce at longer range to maintain this.
-	// We will also check for collisions at this interval along the ray, creating a 'net' with a 20px mesh
+	// Distance between distal ends of ray casts; vision arc will reduce at longer range to maintain this
 	float m_visionAcuity{ 20.0f }; 
 	const float MIN_ACUITY{ 10.0f };
 	const float MAX_ACUITY{ 30.0f };
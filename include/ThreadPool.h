@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// <summary>
+/// @brief A fixed set of worker threads sharing work by stealing.
+/// 
+/// Every worker owns a deque. Tasks submitted from outside the pool are dealt round-robin
+/// across the deques; tasks submitted from inside a task go onto that worker's own deque.
+/// A worker takes its newest task first and, once its deque is empty, steals the oldest
+/// task from another worker, so long and short jobs even out without a central queue.
+/// </summary>
+class ThreadPool
+{
+public:
+	/// <summary>
+	/// @brief Starts the worker threads
+	/// </summary>
+	/// <param name="t_threadCount">Number of workers, 0 to use one per hardware thread</param>
+	ThreadPool(unsigned t_threadCount = 0);
+
+	/// <summary>
+	/// @brief Finishes any queued tasks, then joins the workers
+	/// </summary>
+	~ThreadPool();
+
+	ThreadPool(ThreadPool const&) = delete;
+	ThreadPool& operator=(ThreadPool const&) = delete;
+
+	/// <summary>
+	/// @brief Queues a task to run on one of the workers
+	/// </summary>
+	void submit(std::function<void()> t_task);
+
+	/// <summary>
+	/// @brief Blocks until every submitted task has finished.
+	/// Rethrows the first exception a task threw, if any. Must not be called from inside a task.
+	/// </summary>
+	void wait();
+
+	inline unsigned getThreadCount() const { return static_cast<unsigned>(m_threads.size()); }
+
+private:
+	struct WorkQueue
+	{
+		std::mutex mutex;
+		std::deque<std::function<void()>> tasks;
+	};
+
+	/// <summary>
+	/// @brief Runs tasks until the pool shuts down
+	/// </summary>
+	/// <param name="t_index">Index of this worker's own queue</param>
+	void workerLoop(unsigned t_index);
+
+	/// <summary>
+	/// @brief Takes the newest task from our own queue, or else the oldest task from another's
+	/// </summary>
+	/// <returns>false if every queue was empty</returns>
+	bool takeTask(unsigned t_index, std::function<void()>& t_task);
+
+	std::vector<std::unique_ptr<WorkQueue>> m_queues;
+	std::vector<std::thread> m_threads;
+
+	// guards sleeping/waking; m_queued only ever goes up while this is held so wake-ups aren't lost
+	std::mutex m_stateMutex;
+	std::condition_variable m_workAvailable;
+	std::condition_variable m_allDone;
+
+	std::atomic<unsigned> m_queued{ 0 }; // tasks sitting in a queue
+	std::atomic<unsigned> m_unfinished{ 0 }; // tasks submitted but not yet finished
+	std::atomic<unsigned> m_nextQueue{ 0 }; // round-robin position for outside submissions
+
+	std::exception_ptr m_firstError;
+	bool m_stopping{ false };
+};
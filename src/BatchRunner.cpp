@@ -0,0 +1,134 @@
+#include "BatchRunner.h"
+#include <algorithm>
+#include <memory>
+
+BatchRunner::BatchRunner(LevelData const& t_level, InputScript const& t_script, unsigned t_maxTicks) :
+	ref_level(t_level),
+	ref_script(t_script),
+	m_maxTicks(t_maxTicks),
+	m_tick(sf::seconds(1.0f / t_script.getUpdateRate()))
+{
+}
+
+////////////////////////////////////////////////////////////
+
+std::vector<MatchResult> BatchRunner::run(unsigned t_matchCount, unsigned t_firstSeed, ThreadPool& t_pool)
+{
+	// each task writes only its own slot, so no locking is needed
+	std::vector<MatchResult> results(t_matchCount);
+
+	for (unsigned i = 0; i < t_matchCount; i++)
+	{
+		t_pool.submit([this, &results, i, t_firstSeed]
+		{
+			results[i] = runMatch(t_firstSeed + i);
+		});
+	}
+
+	t_pool.wait();
+
+	return results;
+}
+
+////////////////////////////////////////////////////////////
+
+MatchResult BatchRunner::runMatch(unsigned t_seed) const
+{
+	// worlds are large (projectile pools, particle systems), keep them off the worker's stack
+	std::unique_ptr<GameWorld> world{ std::make_unique<GameWorld>(m_noTexture, ref_level, t_seed) };
+	world->init();
+
+	MatchResult result;
+	result.seed = t_seed;
+
+	for (; result.ticks < m_maxTicks && GameWorld::Outcome::InProgress == world->getOutcome(); result.ticks++)
+	{
+		world->update(ref_script.getInput(result.ticks), m_tick);
+
+		for (GameEvent const& event : world->getEvents())
+		{
+			switch (event.type)
+			{
+			case GameEvent::Type::EnemyFired:
+				result.enemyShots++;
+				break;
+			case GameEvent::Type::PlayerHit:
+				result.playerHitsTaken++;
+				break;
+			case GameEvent::Type::EnemyHit:
+				result.enemyHitsTaken++;
+				break;
+			default:
+				break;
+			}
+		}
+
+		world->getEvents().clear();
+	}
+
+	GameData const& data{ world->getGameData() };
+
+	result.outcome = world->getOutcome();
+	result.simTime = world->getMatchTime().asSeconds();
+	result.score = data.score;
+	result.targetsCollected = data.targetsCollected;
+	result.timePerTarget = data.timePerTarget;
+
+	return result;
+}
+
+////////////////////////////////////////////////////////////
+
+void BatchRunner::report(std::vector<MatchResult> const& t_results, std::ostream& t_out)
+{
+	unsigned wins{ 0 };
+	unsigned losses{ 0 };
+	unsigned long long totalTicks{ 0 };
+	double totalScore{ 0.0 };
+	double totalTargetTime{ 0.0 };
+	std::size_t targetTimeCount{ 0 };
+
+	t_out << "seed\toutcome\tticks\tsimTime\tscore\ttargets\tshots\thitsTaken\tenemyHits\n";
+
+	for (MatchResult const& result : t_results)
+	{
+		const char* outcome{ "undecided" };
+
+		switch (result.outcome)
+		{
+		case GameWorld::Outcome::PlayerWon:
+			outcome = "won";
+			wins++;
+			break;
+		case GameWorld::Outcome::PlayerLost:
+			outcome = "lost";
+			losses++;
+			break;
+		default:
+			break;
+		}
+
+		totalTicks += result.ticks;
+		totalScore += result.score;
+
+		for (float time : result.timePerTarget)
+		{
+			totalTargetTime += time;
+		}
+
+		targetTimeCount += result.timePerTarget.size();
+
+		t_out << result.seed << '\t' << outcome << '\t' << result.ticks << '\t' << result.simTime << '\t'
+			<< result.score << '\t' << result.targetsCollected << '\t' << result.enemyShots << '\t'
+			<< result.playerHitsTaken << '\t' << result.enemyHitsTaken << '\n';
+	}
+
+	const double matches{ static_cast<double>(std::max<std::size_t>(t_results.size(), 1)) };
+
+	t_out << "\nmatches: " << t_results.size()
+		<< "\nwon: " << wins << "  lost: " << losses << "  undecided: " << t_results.size() - wins - losses
+		<< "\ntotal ticks: " << totalTicks
+		<< "\nmean score: " << totalScore / matches
+		<< "\nmean time per target: " << ((targetTimeCount > 0) ? totalTargetTime / targetTimeCount : 0.0) << "s"
+		<< std::endl;
+}
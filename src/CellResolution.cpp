@@ -10,7 +10,8 @@ int CellResolution::getGridRef(sf::Vector2f t_pos)
 	{
 		if (t_pos.x < ScreenSize::s_width * 2.0f && t_pos.y < ScreenSize::s_height * 2.0f)
 		{
-			return (floor(t_pos.x / CELL_SIZE.x) * 10) + floor(t_pos.y / CELL_SIZE.y);
+			// column-major; each column holds WORLD_ROWS cells, so no two cells can share a key
+			return getGridRef(static_cast<int>(t_pos.x / CELL_SIZE.x), static_cast<int>(t_pos.y / CELL_SIZE.y));
 		}
 	}
 
@@ -19,6 +20,35 @@ int CellResolution::getGridRef(sf::Vector2f t_pos)
 
 ////////////////////////////////////////////////////////////
 
+int CellResolution::getGridRef(int t_col, int t_row)
+{
+	if (t_col < 0 || t_row < 0 || t_col >= WORLD_COLS || t_row >= WORLD_ROWS)
+	{
+		return -1;
+	}
+
+	return t_col * WORLD_ROWS + t_row;
+}
+
+////////////////////////////////////////////////////////////
+
+sf::Vector2i CellResolution::getCellCoords(sf::Vector2f t_pos)
+{
+	int col{ static_cast<int>(std::floor(t_pos.x / CELL_SIZE.x)) };
+	int row{ static_cast<int>(std::floor(t_pos.y / CELL_SIZE.y)) };
+
+	return { std::clamp(col, 0, WORLD_COLS - 1), std::clamp(row, 0, WORLD_ROWS - 1) };
+}
+
+////////////////////////////////////////////////////////////
+
+sf::Vector2f CellResolution::getCellPosition(int t_gridRef)
+{
+	return { (t_gridRef / WORLD_ROWS) * CELL_SIZE.x, (t_gridRef % WORLD_ROWS) * CELL_SIZE.y };
+}
+
+////////////////////////////////////////////////////////////
+
 std::array<sf::Vector2f, 4> CellResolution::getCorners(sf::Sprite & t_sprite)
 {
 	std::array<sf::Vector2f, 4> corners;
@@ -31,4 +61,4 @@ std::array<sf::Vector2f, 4> CellResolution::getCorners(sf::Sprite & t_sprite)
 	corners.at(3) = t_sprite.getTransform().transformPoint(0, bounds.height);
 
 	return corners;
-}
\ No newline at end of file
+}
@@ -1,19 +1,174 @@
 #include "CollisionDetector.h"
+#include "MathUtility.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define COLLISION_USE_SSE
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+	/// <summary>
+	/// @brief True if the bounding circles of the two boxes overlap
+	/// </summary>
+	inline bool circlesOverlap(sf::Vector2f t_centre1, float t_radius1, sf::Vector2f t_centre2, float t_radius2)
+	{
+		sf::Vector2f distance = t_centre1 - t_centre2;
+		float radii = t_radius1 + t_radius2;
+
+		return distance.x * distance.x + distance.y * distance.y <= radii * radii;
+	}
+
+	/// <summary>
+	/// @brief True if the AABB of a box overlaps box i of a batch
+	/// </summary>
+	inline bool boundsOverlap(sf::FloatRect const& t_bounds, const OrientedBoundingBoxBatch& batch, std::size_t i)
+	{
+		return !(t_bounds.left > batch.MaxX[i] || batch.MinX[i] > t_bounds.left + t_bounds.width ||
+			t_bounds.top > batch.MaxY[i] || batch.MinY[i] > t_bounds.top + t_bounds.height);
+	}
+
+	/// <summary>
+	/// @brief Scalar SAT of one box against box i of a batch, used for the tail and when SSE isn't available
+	/// </summary>
+	bool batchCollision(const OrientedBoundingBox& OBB, const OrientedBoundingBoxBatch& batch, std::size_t i)
+	{
+		const sf::Vector2f Axes[4] = {
+			OBB.Axes[0],
+			OBB.Axes[1],
+			sf::Vector2f(batch.X[1][i] - batch.X[0][i], batch.Y[1][i] - batch.Y[0][i]),
+			sf::Vector2f(batch.X[3][i] - batch.X[0][i], batch.Y[3][i] - batch.Y[0][i])
+		};
+
+		for (int a = 0; a < 4; a++)
+		{
+			float MinOBB1, MaxOBB1;
+			OBB.ProjectOntoAxis(Axes[a], MinOBB1, MaxOBB1);
+
+			float MinOBB2 = batch.X[0][i] * Axes[a].x + batch.Y[0][i] * Axes[a].y;
+			float MaxOBB2 = MinOBB2;
+
+			for (int j = 1; j < 4; j++)
+			{
+				float Projection = batch.X[j][i] * Axes[a].x + batch.Y[j][i] * Axes[a].y;
+				MinOBB2 = std::min(MinOBB2, Projection);
+				MaxOBB2 = std::max(MaxOBB2, Projection);
+			}
+
+			if (!((MinOBB2 <= MaxOBB1) && (MaxOBB2 >= MinOBB1)))
+				return false;
+		}
+
+		return true;
+	}
+
+#ifdef COLLISION_USE_SSE
+	/// <summary>
+	/// @brief Projects four corners per lane onto a per-lane axis and returns the interval in each lane
+	/// </summary>
+	inline void projectLanes(const __m128 t_x[4], const __m128 t_y[4], __m128 t_axisX, __m128 t_axisY, __m128& t_min, __m128& t_max)
+	{
+		t_min = _mm_add_ps(_mm_mul_ps(t_x[0], t_axisX), _mm_mul_ps(t_y[0], t_axisY));
+		t_max = t_min;
+
+		for (int j = 1; j < 4; j++)
+		{
+			__m128 projection = _mm_add_ps(_mm_mul_ps(t_x[j], t_axisX), _mm_mul_ps(t_y[j], t_axisY));
+			t_min = _mm_min_ps(t_min, projection);
+			t_max = _mm_max_ps(t_max, projection);
+		}
+	}
+
+	/// <summary>
+	/// @brief Lanes where the two intervals don't overlap, i.e. the axis separates the boxes
+	/// </summary>
+	inline __m128 separated(__m128 t_min1, __m128 t_max1, __m128 t_min2, __m128 t_max2)
+	{
+		return _mm_or_ps(_mm_cmpgt_ps(t_min2, t_max1), _mm_cmplt_ps(t_max2, t_min1));
+	}
+
+	/// <summary>
+	/// @brief How many of the four lanes are set in a movemask
+	/// </summary>
+	inline int laneCount(unsigned t_lanes)
+	{
+		return static_cast<int>((t_lanes & 1u) + ((t_lanes >> 1) & 1u) + ((t_lanes >> 2) & 1u) + ((t_lanes >> 3) & 1u));
+	}
+#endif
+}
+
+////////////////////////////////////////////////////////////
+
+CollisionDetector::Stats& CollisionDetector::getStats()
+{
+	thread_local Stats stats;
+	return stats;
+}
+
+////////////////////////////////////////////////////////////
+
+void CollisionDetector::resetStats()
+{
+	Stats& stats = getStats();
+
+	stats.pairsTested = 0;
+	stats.circleRejected = 0;
+	stats.aabbRejected = 0;
+	stats.satRejected = 0;
+	stats.collisions = 0;
+}
+
+////////////////////////////////////////////////////////////
+
+void CollisionDetector::addStatsTo(Stats& t_total)
+{
+	Stats& stats = getStats();
+
+	// exchange before adding, so this is still right when the total is our own
+	t_total.pairsTested.fetch_add(stats.pairsTested.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+	t_total.circleRejected.fetch_add(stats.circleRejected.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+	t_total.aabbRejected.fetch_add(stats.aabbRejected.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+	t_total.satRejected.fetch_add(stats.satRejected.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+	t_total.collisions.fetch_add(stats.collisions.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+}
 
 bool CollisionDetector::collision(const sf::Sprite& object1, const sf::Sprite& object2) {
 	OrientedBoundingBox OBB1(object1);
 	OrientedBoundingBox OBB2(object2);
 
-	// Create the four distinct axes that are perpendicular to the edges of the two rectangles
-	sf::Vector2f Axes[4] = {
-		sf::Vector2f(OBB1.Points[1].x - OBB1.Points[0].x,
-		OBB1.Points[1].y - OBB1.Points[0].y),
-		sf::Vector2f(OBB1.Points[1].x - OBB1.Points[2].x,
-		OBB1.Points[1].y - OBB1.Points[2].y),
-		sf::Vector2f(OBB2.Points[0].x - OBB2.Points[3].x,
-		OBB2.Points[0].y - OBB2.Points[3].y),
-		sf::Vector2f(OBB2.Points[0].x - OBB2.Points[1].x,
-		OBB2.Points[0].y - OBB2.Points[1].y)
+	return collision(OBB1, OBB2);
+}
+
+////////////////////////////////////////////////////////////
+
+bool CollisionDetector::collision(const OrientedBoundingBox& OBB1, const OrientedBoundingBox& OBB2) {
+	Stats& stats = getStats();
+	stats.pairsTested.fetch_add(1, std::memory_order_relaxed);
+
+	// Cheapest first: boxes whose bounding circles don't touch can't collide...
+	if (!circlesOverlap(OBB1.Centre, OBB1.Radius, OBB2.Centre, OBB2.Radius))
+	{
+		stats.circleRejected.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	// ... and neither can boxes whose AABBs don't
+	if (OBB1.Bounds.left > OBB2.Bounds.left + OBB2.Bounds.width || OBB2.Bounds.left > OBB1.Bounds.left + OBB1.Bounds.width ||
+		OBB1.Bounds.top > OBB2.Bounds.top + OBB2.Bounds.height || OBB2.Bounds.top > OBB1.Bounds.top + OBB1.Bounds.height)
+	{
+		stats.aabbRejected.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	// The four distinct axes that are perpendicular to the edges of the two rectangles
+	// (a rectangle's edges are perpendicular to each other, so the edges themselves will do)
+	const sf::Vector2f Axes[4] = {
+		OBB1.Axes[0],
+		OBB1.Axes[1],
+		OBB2.Axes[0],
+		OBB2.Axes[1]
 	};
 
 	for (int i = 0; i<4; i++) // For each axis...
@@ -27,8 +182,323 @@ bool CollisionDetector::collision(const sf::Sprite& object1, const sf::Sprite& o
 		// ... and check whether the outermost projected points of both OBBs overlap.
 		// If this is not the case, the Seperating Axis Theorem states that there can be no collision between the rectangles
 		if (!((MinOBB2 <= MaxOBB1) && (MaxOBB2 >= MinOBB1)))
+		{
+			stats.satRejected.fetch_add(1, std::memory_order_relaxed);
 			return false;
+		}
 	}
 
+	stats.collisions.fetch_add(1, std::memory_order_relaxed);
 	return true;	// Collision detected!
 }
+
+////////////////////////////////////////////////////////////
+
+int CollisionDetector::collision(const OrientedBoundingBox& OBB, const OrientedBoundingBoxBatch& batch, std::vector<std::uint32_t>& hitMask)
+{
+	const std::size_t count = batch.Size();
+
+	hitMask.assign((count + 31) / 32, 0u);
+
+	int hits = 0;
+	int circleRejected = 0;
+	int aabbRejected = 0;
+	std::size_t i = 0;
+
+#ifdef COLLISION_USE_SSE
+	const __m128 centreX1 = _mm_set1_ps(OBB.Centre.x);
+	const __m128 centreY1 = _mm_set1_ps(OBB.Centre.y);
+	const __m128 radius1 = _mm_set1_ps(OBB.Radius);
+
+	const __m128 minX1 = _mm_set1_ps(OBB.Bounds.left);
+	const __m128 maxX1 = _mm_set1_ps(OBB.Bounds.left + OBB.Bounds.width);
+	const __m128 minY1 = _mm_set1_ps(OBB.Bounds.top);
+	const __m128 maxY1 = _mm_set1_ps(OBB.Bounds.top + OBB.Bounds.height);
+
+	// The single box's corners, splatted across all four lanes
+	__m128 x1[4], y1[4];
+
+	for (int j = 0; j < 4; j++)
+	{
+		x1[j] = _mm_set1_ps(OBB.Points[j].x);
+		y1[j] = _mm_set1_ps(OBB.Points[j].y);
+	}
+
+	// Its own two axes project to the same interval against every lane, so do those once
+	__m128 axisMin1[2], axisMax1[2];
+
+	for (int a = 0; a < 2; a++)
+	{
+		float Min, Max;
+		OBB.ProjectOntoAxis(OBB.Axes[a], Min, Max);
+		axisMin1[a] = _mm_set1_ps(Min);
+		axisMax1[a] = _mm_set1_ps(Max);
+	}
+
+	for (; i + 4 <= count; i += 4)
+	{
+		// Bounding circles first; if none of the four lanes are near us, skip SAT entirely
+		__m128 distanceX = _mm_sub_ps(_mm_loadu_ps(&batch.CentreX[i]), centreX1);
+		__m128 distanceY = _mm_sub_ps(_mm_loadu_ps(&batch.CentreY[i]), centreY1);
+		__m128 radii = _mm_add_ps(_mm_loadu_ps(&batch.Radius[i]), radius1);
+
+		__m128 near = _mm_cmple_ps(_mm_add_ps(_mm_mul_ps(distanceX, distanceX), _mm_mul_ps(distanceY, distanceY)), _mm_mul_ps(radii, radii));
+		unsigned nearLanes = static_cast<unsigned>(_mm_movemask_ps(near));
+
+		circleRejected += 4 - laneCount(nearLanes);
+
+		if (nearLanes == 0u)
+			continue;
+
+		// Then AABBs, of the lanes that got past the circles
+		__m128 clear = _mm_or_ps(
+			_mm_or_ps(_mm_cmpgt_ps(minX1, _mm_loadu_ps(&batch.MaxX[i])), _mm_cmpgt_ps(_mm_loadu_ps(&batch.MinX[i]), maxX1)),
+			_mm_or_ps(_mm_cmpgt_ps(minY1, _mm_loadu_ps(&batch.MaxY[i])), _mm_cmpgt_ps(_mm_loadu_ps(&batch.MinY[i]), maxY1)));
+		unsigned overlapLanes = static_cast<unsigned>(~_mm_movemask_ps(clear)) & nearLanes;
+
+		aabbRejected += laneCount(nearLanes) - laneCount(overlapLanes);
+
+		if (overlapLanes == 0u)
+			continue;
+
+		__m128 x2[4], y2[4];
+
+		for (int j = 0; j < 4; j++)
+		{
+			x2[j] = _mm_loadu_ps(&batch.X[j][i]);
+			y2[j] = _mm_loadu_ps(&batch.Y[j][i]);
+		}
+
+		__m128 apart = _mm_setzero_ps();
+		__m128 min1, max1, min2, max2;
+
+		// Axes of the single box
+		for (int a = 0; a < 2; a++)
+		{
+			projectLanes(x2, y2, _mm_set1_ps(OBB.Axes[a].x), _mm_set1_ps(OBB.Axes[a].y), min2, max2);
+			apart = _mm_or_ps(apart, separated(axisMin1[a], axisMax1[a], min2, max2));
+		}
+
+		// Axes of each batch box, different in every lane
+		const int edgeEnd[2] = { 1, 3 };
+
+		for (int a = 0; a < 2; a++)
+		{
+			__m128 axisX = _mm_sub_ps(x2[edgeEnd[a]], x2[0]);
+			__m128 axisY = _mm_sub_ps(y2[edgeEnd[a]], y2[0]);
+
+			projectLanes(x1, y1, axisX, axisY, min1, max1);
+			projectLanes(x2, y2, axisX, axisY, min2, max2);
+			apart = _mm_or_ps(apart, separated(min1, max1, min2, max2));
+		}
+
+		// Boxes no axis separates are colliding
+		unsigned lanes = static_cast<unsigned>(~_mm_movemask_ps(apart)) & overlapLanes;
+
+		for (unsigned lane = 0; lane < 4; lane++)
+		{
+			if (lanes & (1u << lane))
+			{
+				hitMask[(i + lane) / 32] |= 1u << ((i + lane) % 32);
+				hits++;
+			}
+		}
+	}
+#endif
+
+	// Whatever didn't fill a full set of lanes
+	for (; i < count; i++)
+	{
+		if (!circlesOverlap(OBB.Centre, OBB.Radius, sf::Vector2f(batch.CentreX[i], batch.CentreY[i]), batch.Radius[i]))
+		{
+			circleRejected++;
+		}
+		else if (!boundsOverlap(OBB.Bounds, batch, i))
+		{
+			aabbRejected++;
+		}
+		else if (batchCollision(OBB, batch, i))
+		{
+			hitMask[i / 32] |= 1u << (i % 32);
+			hits++;
+		}
+	}
+
+	// One update per batch rather than per pair keeps the counters cheap
+	Stats& stats = getStats();
+	stats.pairsTested.fetch_add(count, std::memory_order_relaxed);
+	stats.circleRejected.fetch_add(circleRejected, std::memory_order_relaxed);
+	stats.aabbRejected.fetch_add(aabbRejected, std::memory_order_relaxed);
+	stats.satRejected.fetch_add(count - circleRejected - aabbRejected - hits, std::memory_order_relaxed);
+	stats.collisions.fetch_add(hits, std::memory_order_relaxed);
+
+	return hits;
+}
+
+////////////////////////////////////////////////////////////
+
+void RayFan::Reset(sf::Vector2f Start, float Distance)
+{
+	Origin = Start;
+	MaxDistance = Distance;
+	DirX.clear();
+	DirY.clear();
+	Nearest.clear();
+}
+
+////////////////////////////////////////////////////////////
+
+void RayFan::Add(sf::Vector2f Direction)
+{
+	DirX.push_back(Direction.x);
+	DirY.push_back(Direction.y);
+	Nearest.push_back(MaxDistance);
+}
+
+////////////////////////////////////////////////////////////
+
+void CollisionDetector::rayFanBox(RayFan& t_fan, const OrientedBoundingBox& t_box)
+{
+	const std::size_t count = t_fan.Size();
+	const sf::Vector2f toCentre = t_box.Centre - t_fan.Origin;
+
+	// Every ray starts at the same point, so the distance to the centre is shared by all of them
+	const float centreSquared = toCentre.x * toCentre.x + toCentre.y * toCentre.y;
+	const float radiusSquared = t_box.Radius * t_box.Radius;
+
+	// Too far away for any ray to reach
+	if (std::sqrt(centreSquared) - t_box.Radius > t_fan.MaxDistance)
+		return;
+
+	// Rays that reach the bounding circle before anything nearer are clipped against the box itself.
+	// Always along the full ray, so where a ray stops doesn't depend on which boxes were tested first
+	auto clip = [&t_fan, &t_box](std::size_t t_ray)
+	{
+		sf::Vector2f direction(t_fan.DirX[t_ray], t_fan.DirY[t_ray]);
+		float hitTime;
+
+		if (segmentCollision(t_fan.Origin, t_fan.Origin + direction * t_fan.MaxDistance, t_box, hitTime))
+		{
+			t_fan.Nearest[t_ray] = std::min(t_fan.Nearest[t_ray], hitTime * t_fan.MaxDistance);
+		}
+	};
+
+	std::size_t i = 0;
+
+#ifdef COLLISION_USE_SSE
+	const __m128 toCentreX = _mm_set1_ps(toCentre.x);
+	const __m128 toCentreY = _mm_set1_ps(toCentre.y);
+	const __m128 centreSquared4 = _mm_set1_ps(centreSquared);
+	const __m128 radiusSquared4 = _mm_set1_ps(radiusSquared);
+	const __m128 zero = _mm_setzero_ps();
+
+	for (; i + 4 <= count; i += 4)
+	{
+		// Distance along each ray to its closest approach to the centre, and how far it misses by (squared)
+		__m128 along = _mm_add_ps(_mm_mul_ps(toCentreX, _mm_loadu_ps(&t_fan.DirX[i])), _mm_mul_ps(toCentreY, _mm_loadu_ps(&t_fan.DirY[i])));
+		__m128 missSquared = _mm_sub_ps(centreSquared4, _mm_mul_ps(along, along));
+
+		__m128 halfChord = _mm_sqrt_ps(_mm_max_ps(_mm_sub_ps(radiusSquared4, missSquared), zero));
+
+		// Rays that pass through the circle, and don't have it entirely behind them
+		__m128 hit = _mm_and_ps(_mm_cmple_ps(missSquared, radiusSquared4), _mm_cmpge_ps(_mm_add_ps(along, halfChord), zero));
+
+		// Entry distance, 0 if the origin is already inside; the box can't be any nearer than this
+		__m128 entry = _mm_max_ps(_mm_sub_ps(along, halfChord), zero);
+
+		unsigned lanes = static_cast<unsigned>(_mm_movemask_ps(_mm_and_ps(hit, _mm_cmplt_ps(entry, _mm_loadu_ps(&t_fan.Nearest[i])))));
+
+		for (unsigned lane = 0; lane < 4; lane++)
+		{
+			if (lanes & (1u << lane))
+			{
+				clip(i + lane);
+			}
+		}
+	}
+#endif
+
+	// Whatever didn't fill a full set of lanes
+	for (; i < count; i++)
+	{
+		float entry = MathUtility::rayCircleIntersection(t_fan.Origin, sf::Vector2f(t_fan.DirX[i], t_fan.DirY[i]), t_box.Centre, t_box.Radius);
+
+		if (entry < t_fan.Nearest[i])
+		{
+			clip(i);
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////
+
+bool CollisionDetector::segmentCollision(sf::Vector2f t_start, sf::Vector2f t_end, const OrientedBoundingBox& t_box, float& t_hitTime)
+{
+	// Work in the box's own frame, where it's the unit square spanned by its two edges
+	sf::Vector2f edges[2] = {
+		t_box.Points[1] - t_box.Points[0],
+		t_box.Points[3] - t_box.Points[0]
+	};
+
+	sf::Vector2f start = t_start - t_box.Points[0];
+	sf::Vector2f delta = t_end - t_start;
+
+	float tMin = 0.0f;
+	float tMax = 1.0f;
+
+	for (int i = 0; i < 2; i++) // For each edge...
+	{
+		float lengthSquared = edges[i].x * edges[i].x + edges[i].y * edges[i].y;
+
+		if (lengthSquared <= 0.0f)
+			return false;
+
+		// ... find where the segment starts and how far it moves along the edge, in edge lengths ...
+		float origin = (start.x * edges[i].x + start.y * edges[i].y) / lengthSquared;
+		float speed = (delta.x * edges[i].x + delta.y * edges[i].y) / lengthSquared;
+
+		// ... and clip the segment to the slab between the two opposite sides
+		if (speed == 0.0f)
+		{
+			if (origin < 0.0f || origin > 1.0f)
+				return false;
+			continue;
+		}
+
+		float t0 = (0.0f - origin) / speed;
+		float t1 = (1.0f - origin) / speed;
+
+		if (t0 > t1)
+			std::swap(t0, t1);
+
+		tMin = std::max(tMin, t0);
+		tMax = std::min(tMax, t1);
+
+		if (tMin > tMax)
+			return false;
+	}
+
+	t_hitTime = tMin;
+	return true;
+}
+
+////////////////////////////////////////////////////////////
+
+int CollisionDetector::segmentCollision(sf::Vector2f t_start, sf::Vector2f t_end, const std::vector<GameObject*>& t_candidates, float& t_hitTime)
+{
+	int firstHit = -1;
+	t_hitTime = 1.0f;
+
+	for (std::size_t i = 0; i < t_candidates.size(); i++)
+	{
+		float hitTime;
+
+		if (segmentCollision(t_start, t_end, t_candidates[i]->getBoundingBox(), hitTime) && (firstHit == -1 || hitTime < t_hitTime))
+		{
+			firstHit = static_cast<int>(i);
+			t_hitTime = hitTime;
+		}
+	}
+
+	return firstHit;
+}
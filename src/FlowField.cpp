@@ -0,0 +1,231 @@
+#include "FlowField.h"
+#include "CellResolution.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+namespace
+{
+	// The eight neighbours of a tile, orthogonal ones first
+	const int NEIGHBOUR_COL[8]{ 1, -1, 0, 0, 1, 1, -1, -1 };
+	const int NEIGHBOUR_ROW[8]{ 0, 0, 1, -1, 1, -1, 1, -1 };
+	const float NEIGHBOUR_COST[8]{ 1.0f, 1.0f, 1.0f, 1.0f, 1.41421356f, 1.41421356f, 1.41421356f, 1.41421356f };
+
+	/// <summary>
+	/// @brief Distance from a point to the nearest point of an oriented box, 0 if it's inside
+	/// </summary>
+	float distanceToBox(sf::Vector2f t_point, OrientedBoundingBox const& t_box)
+	{
+		sf::Vector2f offset{ t_point - t_box.Points[0] };
+		sf::Vector2f closest{ t_box.Points[0] };
+
+		for (sf::Vector2f const& edge : t_box.Axes)
+		{
+			float lengthSquared{ edge.x * edge.x + edge.y * edge.y };
+
+			if (lengthSquared <= 0.0f) continue;
+
+			// how far along this edge the point projects, clamped to the box
+			float along{ std::clamp((offset.x * edge.x + offset.y * edge.y) / lengthSquared, 0.0f, 1.0f) };
+			closest += edge * along;
+		}
+
+		sf::Vector2f gap{ t_point - closest };
+
+		return std::sqrt(gap.x * gap.x + gap.y * gap.y);
+	}
+}
+
+////////////////////////////////////////////////////////////
+
+FlowField::FlowField()
+{
+	const sf::Vector2f cellSize{ CellResolution::temp_getCellSize() };
+
+	m_cols = static_cast<int>(std::ceil(cellSize.x * CellResolution::WORLD_COLS / TILE_SIZE));
+	m_rows = static_cast<int>(std::ceil(cellSize.y * CellResolution::WORLD_ROWS / TILE_SIZE));
+
+	const std::size_t tiles{ static_cast<std::size_t>(m_cols * m_rows) };
+
+	m_blocked.assign(tiles, 0);
+	m_distance.assign(tiles, INFINITY);
+	m_direction.assign(tiles, { 0.0f, 0.0f });
+}
+
+////////////////////////////////////////////////////////////
+
+void FlowField::build(std::vector<Obstacle>& t_obstacles)
+{
+	std::fill(m_blocked.begin(), m_blocked.end(), 0);
+
+	for (Obstacle& obstacle : t_obstacles)
+	{
+		OrientedBoundingBox const& box{ obstacle.getBoundingBox() };
+
+		// only the tiles around the obstacle's bounds can be close enough
+		int firstCol{ std::max(0, static_cast<int>((box.Bounds.left - CLEARANCE) / TILE_SIZE)) };
+		int lastCol{ std::min(m_cols - 1, static_cast<int>((box.Bounds.left + box.Bounds.width + CLEARANCE) / TILE_SIZE)) };
+		int firstRow{ std::max(0, static_cast<int>((box.Bounds.top - CLEARANCE) / TILE_SIZE)) };
+		int lastRow{ std::min(m_rows - 1, static_cast<int>((box.Bounds.top + box.Bounds.height + CLEARANCE) / TILE_SIZE)) };
+
+		for (int row = firstRow; row <= lastRow; row++)
+		{
+			for (int col = firstCol; col <= lastCol; col++)
+			{
+				sf::Vector2f centre{ (col + 0.5f) * TILE_SIZE, (row + 0.5f) * TILE_SIZE };
+
+				if (distanceToBox(centre, box) < CLEARANCE)
+				{
+					m_blocked[row * m_cols + col] = 1;
+				}
+			}
+		}
+	}
+
+	// the old fill may route through newly blocked tiles
+	if (m_goalTile != -1)
+	{
+		fill();
+	}
+}
+
+////////////////////////////////////////////////////////////
+
+int FlowField::getTile(sf::Vector2f t_position) const
+{
+	int col{ static_cast<int>(std::floor(t_position.x / TILE_SIZE)) };
+	int row{ static_cast<int>(std::floor(t_position.y / TILE_SIZE)) };
+
+	if (col < 0 || row < 0 || col >= m_cols || row >= m_rows)
+	{
+		return -1;
+	}
+
+	return row * m_cols + col;
+}
+
+////////////////////////////////////////////////////////////
+
+bool FlowField::update(sf::Vector2f t_goal)
+{
+	int goalTile{ getTile(t_goal) };
+
+	if (goalTile == m_goalTile)
+	{
+		return false;
+	}
+
+	m_goalTile = goalTile;
+	fill();
+
+	return true;
+}
+
+////////////////////////////////////////////////////////////
+
+sf::Vector2f FlowField::getDirection(sf::Vector2f t_position) const
+{
+	int tile{ getTile(t_position) };
+
+	return (tile == -1) ? sf::Vector2f{ 0.0f, 0.0f } : m_direction[tile];
+}
+
+////////////////////////////////////////////////////////////
+
+void FlowField::fill()
+{
+	PROFILE_SCOPE("FlowField::fill");
+
+	std::fill(m_distance.begin(), m_distance.end(), INFINITY);
+	std::fill(m_direction.begin(), m_direction.end(), sf::Vector2f{ 0.0f, 0.0f });
+
+	if (m_goalTile == -1)
+	{
+		return;
+	}
+
+	// the goal counts as open even if the player is scraping a rock
+	m_distance[m_goalTile] = 0.0f;
+	m_open.clear();
+	m_open.push_back({ 0.0f, m_goalTile });
+
+	auto byDistance = std::greater<std::pair<float, int>>();
+
+	while (!m_open.empty())
+	{
+		std::pop_heap(m_open.begin(), m_open.end(), byDistance);
+		auto [distance, tile] = m_open.back();
+		m_open.pop_back();
+
+		// a shorter route to this tile was already expanded
+		if (distance > m_distance[tile]) continue;
+
+		int col{ tile % m_cols };
+		int row{ tile / m_cols };
+
+		for (int i = 0; i < 8; i++)
+		{
+			int nextCol{ col + NEIGHBOUR_COL[i] };
+			int nextRow{ row + NEIGHBOUR_ROW[i] };
+
+			if (nextCol < 0 || nextRow < 0 || nextCol >= m_cols || nextRow >= m_rows) continue;
+
+			int next{ nextRow * m_cols + nextCol };
+
+			if (m_blocked[next]) continue;
+
+			// no cutting corners between two blocked tiles
+			if (NEIGHBOUR_COL[i] != 0 && NEIGHBOUR_ROW[i] != 0 &&
+				(m_blocked[row * m_cols + nextCol] || m_blocked[nextRow * m_cols + col])) continue;
+
+			float nextDistance{ distance + NEIGHBOUR_COST[i] };
+
+			if (nextDistance < m_distance[next])
+			{
+				m_distance[next] = nextDistance;
+				m_open.push_back({ nextDistance, next });
+				std::push_heap(m_open.begin(), m_open.end(), byDistance);
+			}
+		}
+	}
+
+	// every tile points at its nearest neighbour; blocked tiles too, so a tank pushed against a rock can get off it
+	for (int row = 0; row < m_rows; row++)
+	{
+		for (int col = 0; col < m_cols; col++)
+		{
+			int tile{ row * m_cols + col };
+
+			if (tile == m_goalTile) continue;
+
+			float best{ m_blocked[tile] ? INFINITY : m_distance[tile] };
+			int bestNeighbour{ -1 };
+
+			for (int i = 0; i < 8; i++)
+			{
+				int nextCol{ col + NEIGHBOUR_COL[i] };
+				int nextRow{ row + NEIGHBOUR_ROW[i] };
+
+				if (nextCol < 0 || nextRow < 0 || nextCol >= m_cols || nextRow >= m_rows) continue;
+
+				int next{ nextRow * m_cols + nextCol };
+
+				if (NEIGHBOUR_COL[i] != 0 && NEIGHBOUR_ROW[i] != 0 &&
+					(m_blocked[row * m_cols + nextCol] || m_blocked[nextRow * m_cols + col])) continue;
+
+				if (m_distance[next] < best)
+				{
+					best = m_distance[next];
+					bestNeighbour = i;
+				}
+			}
+
+			if (bestNeighbour != -1)
+			{
+				sf::Vector2f step{ static_cast<float>(NEIGHBOUR_COL[bestNeighbour]), static_cast<float>(NEIGHBOUR_ROW[bestNeighbour]) };
+				m_direction[tile] = step / std::sqrt(step.x * step.x + step.y * step.y);
+			}
+		}
+	}
+}
@@ -1,31 +1,55 @@
 #include "Game.h"
+#include "Profiler.h"
 #include "MathUtility.h"
 #include <iostream>
+#include <iomanip>
+#include <sstream>
 
-// Updates per milliseconds
-static const sf::Time MS_PER_UPDATE = sf::seconds(1.0f/60.0f);
+// Most simulation steps we'll run to catch up in one frame; beyond that the backlog is dropped
+static const int MAX_UPDATES_PER_FRAME = 5;
+
+// CPU time the AI tanks may spend looking around per update, summed over all worker threads
+static const sf::Time AI_PERCEPTION_BUDGET = sf::microseconds(2000);
 
 ////////////////////////////////////////////////////////////
-Game::Game()
-	: m_window(sf::VideoMode(ScreenSize::s_width, ScreenSize::s_height, 32), "SFML Playground", sf::Style::Default),
-	m_tank(m_spriteSheetTexture, m_spatialMap, m_activeTargets, m_topLeftAI, m_trauma),
-	m_topLeftAI(m_spriteSheetTexture, m_spatialMap, m_obstacles, m_trauma),
-	m_topRightAI(m_spriteSheetTexture, m_spatialMap, m_obstacles, m_trauma),
-	m_bottomLeftAI(m_spriteSheetTexture, m_spatialMap, m_obstacles, m_trauma),
-	m_bottomRightAI(m_spriteSheetTexture, m_spatialMap, m_obstacles, m_trauma),
-	m_HUD(m_font, m_gameData, m_gameState)
+Game::Game(unsigned t_seed)
+	: m_world(m_spriteSheetTexture, loadLevel(1), t_seed),
+	m_HUD(m_font, m_world.getGameData(), m_gameState),
+	m_window(sf::VideoMode(ScreenSize::s_width, ScreenSize::s_height, 32), "SFML Playground", sf::Style::Default)
 {
 	// Game runs much faster with this commented out. Why?
 	// Seems to limit our refresh rate to that of the monitor
 	m_window.setVerticalSyncEnabled(true);
 	m_window.setKeyRepeatEnabled(false);
 
-	int currentLevel = 1;
+	m_inputRecording.setSeed(t_seed);
+
+	m_world.setThreadPool(&m_aiWorkers);
+	m_world.setPerceptionBudget(AI_PERCEPTION_BUDGET);
+
+	loadTextures();
+	loadAudio();
+	loadFonts();
+	setupSprites();
+
+	init();
+
+	// set state to GamePlay
+	m_gameState = GameState::GamePlay;
+
+	m_deltaScoreClock.start();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+LevelData Game::loadLevel(int t_levelNumber)
+{
+	LevelData level;
 
 	// Will generate an exception if level loading fails
 	try
 	{
-		LevelLoader::load(currentLevel, m_level);
+		LevelLoader::load(t_levelNumber, level);
 	}
 	catch (std::exception& e)
 	{
@@ -34,25 +58,30 @@ Game::Game()
 		throw e;
 	}
 
-	loadTextures();
-	loadAudio();
-	loadFonts();
-	generateWalls();
-	generateTargets();
-	setupSprites();
+	return level;
+}
 
-	m_topLeftAI.setPatrolZone({ 50.0f, 50.0f, 1390.0f, 800.0f });
-	m_topRightAI.setPatrolZone({ 1490.0f, 50.0f, 1390.0f, 800.0f });
-	m_bottomLeftAI.setPatrolZone({ 50.0f, 950.0f, 1390.0f, 800.0f });
-	m_bottomRightAI.setPatrolZone({ 1490.0f, 950.0f, 1390.0f, 800.0f });
+///////////////////////////////////////////////////////////////////////////////////////////////
 
-	init();
+void Game::setUpdateRate(unsigned t_updatesPerSecond)
+{
+	if (t_updatesPerSecond > 0)
+	{
+		m_timeStep = sf::seconds(1.0f / t_updatesPerSecond);
+		m_inputRecording.setUpdateRate(t_updatesPerSecond);
+	}
+}
 
-	// set state to GamePlay
-	m_gameState = GameState::GamePlay;
+///////////////////////////////////////////////////////////////////////////////////////////////
 
-	m_deltaScoreClock.start();
-	m_targetClock.start();
+void Game::recordInput(std::string const& t_path)
+{
+	m_recordPath = t_path;
+	m_inputRecording.clear();
+
+	// which tanks look around on a tick must not depend on machine speed or the camera, or the replay diverges
+	m_world.setPerceptionBudget(sf::Time::Zero);
+	m_world.setViewArea(sf::FloatRect());
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////
@@ -64,24 +93,34 @@ void Game::run()
 
 	while (m_window.isOpen())
 	{
-		sf::Time dt = clock.restart();
+		sf::Time frameTime{ clock.restart() };
+		lag += frameTime;
 
-		lag += dt;
+		m_world.adaptParticlesToFrameTime(frameTime);
 
 		processEvents();
 
-		while (lag > MS_PER_UPDATE)
+		// after a stall (window dragged, breakpoint hit) skip ahead rather than spiral trying to catch up
+		if (lag > m_timeStep * static_cast<float>(MAX_UPDATES_PER_FRAME))
 		{
-			update(MS_PER_UPDATE);
-			lag -= MS_PER_UPDATE;
+			lag = m_timeStep * static_cast<float>(MAX_UPDATES_PER_FRAME);
 		}
 
-		// this could run faster than 100ups, but still passes 10ms to the update loop
-		// could this mess up game logic that relies on dTime?
-		update(dt);
+		// the simulation only ever sees whole, equal steps
+		while (lag >= m_timeStep)
+		{
+			update(m_timeStep);
+			lag -= m_timeStep;
+		}
 
-		render();
+		// draw the part-way point between the last two steps
+		render(lag / m_timeStep);
 	}
+
+	finishRecording();
+
+	Profiler::get().writeCsv("profile.csv");
+	Profiler::get().writeJson("profile.json");
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////
@@ -92,7 +131,7 @@ void Game::run()
 void Game::loadTextures()
 try
 {
-	if (!m_bgTexture.loadFromFile(m_level.m_background.m_fileName))
+	if (!m_bgTexture.loadFromFile(m_world.getLevel().m_background.m_fileName))
 	{
 		throw std::exception("Error loading background texture from file in game.cpp>loadTextures");
 	}
@@ -104,6 +143,16 @@ try
 	{
 		throw std::exception("Error loading menuBackgroundTexture from file in game.cpp>loadTextures");
 	}
+	if (!m_smokeTexture.loadFromFile(".\\resources\\images\\smoke.png"))
+	{
+		throw std::exception("Error loading smoke texture from file in game.cpp>loadTextures");
+	}
+	if (!m_sparkTexture.loadFromFile(".\\resources\\images\\spark.png"))
+	{
+		throw std::exception("Error loading spark texture from file in game.cpp>loadTextures");
+	}
+
+	m_world.setParticleTextures(m_smokeTexture, m_sparkTexture);
 }
 catch(std::exception& e)
 {
@@ -132,11 +181,7 @@ try
 		std::string msg{ "ERROR: Unable to open file '" + filePath + "'" };
 		throw std::exception(msg.c_str());
 	}
-	
-	m_topLeftAI.setAudio(m_enemyTankFiringBuffer, m_shellImpactBuffer);
-	m_topRightAI.setAudio(m_enemyTankFiringBuffer, m_shellImpactBuffer);
-	m_bottomLeftAI.setAudio(m_enemyTankFiringBuffer, m_shellImpactBuffer);
-	m_bottomRightAI.setAudio(m_enemyTankFiringBuffer, m_shellImpactBuffer);
+
 
 	// ###### TARGET PICKUP SFX ######
 	filePath = ".\\resources\\audio\\PickupTarget.wav";
@@ -208,6 +253,18 @@ try
 	m_traumaMeter.setFont(m_font);
 	m_traumaMeter.setPosition({ 10.0f,30.0f });
 
+	m_collisionStatsText.setFont(m_font);
+	m_collisionStatsText.setCharacterSize(12U);
+	m_collisionStatsText.setPosition({ 10.0f,60.0f });
+
+	m_particleStatsText.setFont(m_font);
+	m_particleStatsText.setCharacterSize(12U);
+	m_particleStatsText.setPosition({ 10.0f,140.0f });
+
+	m_profilerText.setFont(m_font);
+	m_profilerText.setCharacterSize(12U);
+	m_profilerText.setPosition({ ScreenSize::s_width - 420.0f, 60.0f });
+
 	m_deltaScoreText.setFont(m_font);
 	m_deltaScoreText.setCharacterSize(16U);
 	m_deltaScoreText.setFillColor(sf::Color::Yellow);
@@ -226,9 +283,6 @@ catch (std::exception e)
 /// </summary>
 void Game::setupSprites()
 {
-	// Now the level data is loaded, set the tank position in a random corner.
-	m_tank.setPosition(m_level.m_tank.m_position[rand() % 4]);
-
 	m_bgSprite.setTexture(m_bgTexture);
 
 	// overdraw the background slightly to account for later screenshake
@@ -241,36 +295,14 @@ void Game::setupSprites()
 
 void Game::init()
 {
-	// Restart game clocks
-	m_gameClock.restart();
-
-	// Reset trauma/screenshake variable
-	m_trauma = 0.0f;
-
-	// Reset score counters
-	m_targetIndex = 0;
-
-	m_gameData.totalTargets = 10;
-	m_gameData.targetsCollected = 0;
-	m_gameData.timePerTarget.clear();
-	m_gameData.score = 0;
-
-	// Clear targets array and push back first target
-	m_activeTargets.clear();
-	m_activeTargets.push_back(m_allTargets[m_targetIndex]);
+	// Reset the match: clocks, score, targets and AI
+	m_world.init();
 
 	// Get rid of delta score text
 	m_deltaScoreText.setPosition({ -100.0f,-100.0f });
 
-	buildMap();
-
 	m_HUD.init();
 
-	m_topLeftAI.init({ 400.0f, 500.0f });
-	m_topRightAI.init({ 2480.0f, 500.0f });
-	m_bottomLeftAI.init({ 400.0f, 1400.0f });
-	m_bottomRightAI.init({ 2480.0f, 1400.0f });
-
 	m_backgroundMusic.setVolume(100.0f);
 	m_backgroundMusic.play();
 
@@ -280,116 +312,6 @@ void Game::init()
 
 ///////////////////////////////////////////////////////////////////////////////////////////////
 
-void Game::generateWalls()
-{
-	//sf::IntRect wallRect(2, 129, 33, 23);
-
-	sf::IntRect wallRect;
-
-	// Create the Walls 
-	for (ObstacleData const& obstacle : m_level.m_obstacles)
-	{
-		// Randomly choose one of our rock sprites
-		switch (rand() % 3)
-		{
-		case 0:
-			wallRect = { 48, 90, 64, 64 };
-			break;
-		case 1:
-			wallRect = { 112, 90, 96, 64 };
-			break;
-		case 2:
-			wallRect = { 48, 160, 80, 64 };
-			break;
-		default:
-			break;
-		}	
-
-		// Random rotation
-		int rotation = rand() % 360;
-
-		sf::Sprite sprite;
-		sprite.setTexture(m_spriteSheetTexture);
-		sprite.setTextureRect(wallRect);
-		sprite.setOrigin(wallRect.width / 2.0f, wallRect.height / 2.0f);
-		sprite.setPosition(obstacle.m_position);
-		//sprite.setRotation(obstacle.m_baseRotation);
-		sprite.setRotation(rotation);
-
-		m_obstacles.push_back(Obstacle(sprite));
-	}
-}
-
-///////////////////////////////////////////////////////////////////////////////////////////////
-
-void Game::generateTargets()
-{
-	sf::IntRect targetRect(0, 90, 38, 38);
-
-	for (TargetData const& target : m_level.m_targets)
-	{
-		sf::Sprite sprite;
-		sprite.setTexture(m_spriteSheetTexture);
-		sprite.setTextureRect(targetRect);
-		sprite.setOrigin(targetRect.width / 2.0f, targetRect.height / 2.0f);
-		sprite.setPosition(target.m_position);
-
-		float offsetX = static_cast<float>(rand() % target.m_randomOffset.x);
-		float offsetY = static_cast<float>(rand() % target.m_randomOffset.y);
-
-		sprite.move({ offsetX, offsetY });
-
-		m_allTargets.push_back(sprite);
-	}
-}
-
-///////////////////////////////////////////////////////////////////////////////////////////////
-
-void Game::buildMap()
-{
-	// for each obstacle in our vector
-	for (GameObject& obs : m_obstacles)
-	{
-		// for each corner of our obstacle
-		for (sf::Vector2f pos : CellResolution::getCorners(obs.getSprite()))
-		{
-			// find the grid ref
-			int grid{ CellResolution::getGridRef(pos) };
-
-			// If we get an error value back, continue
-			if (grid == -1) continue;
-
-			// check if we already account for this object at this position in our map
-			bool alreadyInList{ false };
-			for (GameObject* mapObject : m_spatialMap[grid])
-			{
-				if (mapObject == &obs)
-				{
-					alreadyInList = true;
-					break;
-				}
-			}
-
-			// associate our obstacle with the grid ref in our map if unaccounted for
-			if (!alreadyInList) (m_spatialMap[grid].push_back(&obs));
-		}
-	}
-}
-
-///////////////////////////////////////////////////////////////////////////////////////////////
-
-void Game::getTurretRotation()
-{
-	sf::Vector2f tankPos = m_tank.position();
-	sf::Vector2i mousePos = sf::Mouse::getPosition(m_window);
-
-	sf::Vector2f vec = { mousePos.x - tankPos.x, mousePos.y - tankPos.y };
-
-	m_tank.setTurretHeading(atan2(vec.y, vec.x));
-}
-
-///////////////////////////////////////////////////////////////////////////////////////////////
-
 void Game::processEvents()
 {
 	sf::Event event;
@@ -407,6 +329,11 @@ void Game::processEvents()
 			{
 				m_window.close();
 			}
+
+			if (event.key.code == sf::Keyboard::F3)
+			{
+				m_showProfiler = !m_showProfiler;
+			}
 		}
 
 		processGameEvents(event);
@@ -426,12 +353,11 @@ void Game::processGameEvents(sf::Event& event)
 			{
 				m_gameState = GameState::Paused;
 				m_backgroundMusic.setVolume(40.0f);
-				m_gameClock.stop();
 			}
 
 			if (sf::Keyboard::C == event.key.code)
 			{
-				m_tank.toggleTurretFree();
+				m_toggleTurretPending = true;
 			}
 		}
 	}
@@ -444,7 +370,6 @@ void Game::processGameEvents(sf::Event& event)
 			{
 				m_gameState = GameState::GamePlay;
 				m_backgroundMusic.setVolume(100.0f);
-				m_gameClock.start();
 			}
 		}
 	}
@@ -456,6 +381,9 @@ void Game::processGameEvents(sf::Event& event)
 		{
 			if (sf::Keyboard::R == event.key.code)
 			{
+				// the restarted match carries on from the world's random stream, so a replay from the seed would diverge
+				finishRecording();
+
 				init();
 				m_gameState = GameState::GamePlay;
 			}
@@ -465,95 +393,73 @@ void Game::processGameEvents(sf::Event& event)
 
 ///////////////////////////////////////////////////////////////////////////////////////////////
 
-void Game::handleKeyInput()
+PlayerInput Game::readInput()
 {
-	if (sf::Keyboard::isKeyPressed(sf::Keyboard::Up) || // UP or W
-		sf::Keyboard::isKeyPressed(sf::Keyboard::W))
-	{
-		m_tank.increaseSpeed();
-	}
+	PlayerInput input;
 
-	if (sf::Keyboard::isKeyPressed(sf::Keyboard::Down) || // DOWN or S
-		sf::Keyboard::isKeyPressed(sf::Keyboard::S))
-	{
-		m_tank.decreaseSpeed();
-	}
+	input.forward = sf::Keyboard::isKeyPressed(sf::Keyboard::Up) || // UP or W
+		sf::Keyboard::isKeyPressed(sf::Keyboard::W);
 
-	if (sf::Keyboard::isKeyPressed(sf::Keyboard::Left) || // LEFT or A
-		sf::Keyboard::isKeyPressed(sf::Keyboard::A))
-	{
-		m_tank.decreaseRotation();
-	}
+	input.back = sf::Keyboard::isKeyPressed(sf::Keyboard::Down) || // DOWN or S
+		sf::Keyboard::isKeyPressed(sf::Keyboard::S);
 
-	if (sf::Keyboard::isKeyPressed(sf::Keyboard::Right) || // RIGHT or D
-		sf::Keyboard::isKeyPressed(sf::Keyboard::D))
-	{
-		m_tank.increaseRotation();
-	}
+	input.left = sf::Keyboard::isKeyPressed(sf::Keyboard::Left) || // LEFT or A
+		sf::Keyboard::isKeyPressed(sf::Keyboard::A);
+
+	input.right = sf::Keyboard::isKeyPressed(sf::Keyboard::Right) || // RIGHT or D
+		sf::Keyboard::isKeyPressed(sf::Keyboard::D);
+
+	// key presses arrive as events between updates, so hand the toggle over exactly once
+	input.toggleTurretFree = m_toggleTurretPending;
+	m_toggleTurretPending = false;
+
+	sf::Vector2i mousePos = sf::Mouse::getPosition(m_window);
+	input.aimPosition = { static_cast<float>(mousePos.x), static_cast<float>(mousePos.y) };
+
+	return input;
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////
 
 void Game::update(sf::Time dt)
 {
+	PROFILE_SCOPE("Game::update");
+
 	switch (m_gameState)
 	{
 	case GameState::Loading:
 		break;
 	case GameState::GamePlay:
+	{
+		PlayerInput input{ readInput() };
 
-		handleKeyInput();
-
-		getTurretRotation();
-
-		// Check for collisions with AI tank
-		if (m_topLeftAI.collidesWithPlayer(m_tank) ||
-			m_topRightAI.collidesWithPlayer(m_tank) ||
-			m_bottomLeftAI.collidesWithPlayer(m_tank) ||
-			m_bottomRightAI.collidesWithPlayer(m_tank))
-		{ 
-			gameOver();
-		}
-
-		if (m_gameData.targetsCollected >= m_gameData.totalTargets)
+		if (!m_recordPath.empty())
 		{
-			m_gameState = GameState::GameWin;
-			m_victoryFanfareSound.play();
-			m_tank.reset();
+			m_inputRecording.record(m_tick, input);
 		}
 
-		if (m_tank.getHealth() <= 0.0f)
+		m_tick++;
+
+		// AI tanks the player can't see look around less often; judged from the steady camera, not the shaken view
+		if (m_recordPath.empty())
 		{
-			gameOver();
+			const sf::Vector2f viewSize{ m_window.getDefaultView().getSize() };
+			m_world.setViewArea({ cameraCentre(1.0f, { 0.0f, 0.0f }) - viewSize / 2.0f, viewSize });
 		}
 
-		checkTargetsHit();
-
-		m_tank.update(dt);
-
-		m_topLeftAI.update(m_tank, dt);
-		m_topRightAI.update(m_tank, dt);
-		m_bottomLeftAI.update(m_tank, dt);
-		m_bottomRightAI.update(m_tank, dt);
+		m_world.update(input, dt);
 
-		// update game time for HUD
-		m_gameData.timeElapsed = m_gameClock.getElapsedTime().asSeconds();
+		processWorldEvents();
 
-		// update player health for HUD
-		m_gameData.playerHealth = m_tank.getHealth();
-
-		// update player damage for HUD
-		m_gameData.tankDamage = m_tank.getDamage();
-
-		// reduce trauma linearly to zero
-		(m_trauma > 0.005f) ? m_trauma -= 0.005f : m_trauma = 0.0f;
-		m_traumaMeter.setString(std::to_string(m_trauma));
+		m_traumaMeter.setString(std::to_string(m_world.getTrauma()));
 
 		fadeDeltaScoreText();
 
-		shakeScreen();
+		updateCollisionStats();
+		updateParticleStats();
 
 		break;
+	}
 	case GameState::GameOver:
 		if (m_backgroundMusic.getVolume() > 0.2f)
 		{
@@ -583,65 +489,57 @@ void Game::update(sf::Time dt)
 
 ///////////////////////////////////////////////////////////////////////////////////////////////
 
-void Game::checkTargetsHit()
+void Game::processWorldEvents()
 {
-	// setup our new target
-	for (auto& t : m_activeTargets)
+	for (GameEvent const& event : m_world.getEvents())
 	{
-		if (t.isHit())
+		switch (event.type)
 		{
-			// How long did it take the player to hit the target?
-			sf::Time targetTime{ m_targetClock.getElapsedTime() };
-			m_gameData.timePerTarget.push_back(targetTime.asSeconds());
-
-			m_targetClock.restart();
-
+		case GameEvent::Type::EnemyFired:
+			playEffect(m_enemyTankFiringBuffer, event.position);
+			break;
+		case GameEvent::Type::ShellImpact:
+			playEffect(m_shellImpactBuffer, event.position);
+			break;
+		case GameEvent::Type::TargetCollected:
 			m_targetPickupSound.play();
-			m_gameData.targetsCollected++;
 
-			int deltaScore{ calculateScore(targetTime) };
-			m_gameData.score += deltaScore;
-			
-			t.reset();
-
-			m_deltaScoreText.setString("+" + std::to_string(deltaScore));
-			m_deltaScoreText.setPosition(t.getSprite().getPosition());
+			m_deltaScoreText.setString("+" + std::to_string(event.value));
+			m_deltaScoreText.setPosition(event.position);
 
 			m_deltaScoreClock.restart();
-
-			nextTarget();
+			break;
+		case GameEvent::Type::PlayerWon:
+			m_gameState = GameState::GameWin;
+			m_victoryFanfareSound.play();
+			break;
+		case GameEvent::Type::PlayerLost:
+			m_gameState = GameState::GameOver;
+			m_gameOverMusic.play();
+			break;
+		default:
+			break;
 		}
 	}
+
+	m_world.getEvents().clear();
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////
 
-int Game::calculateScore(sf::Time t_timeToHit)
+void Game::playEffect(sf::SoundBuffer const& t_buffer, sf::Vector2f t_position)
 {
-	// Maximum score it's possible to get per target
-	int maxScore{ 1000 };
+	sf::Sound& sound{ m_effectSounds[m_nextEffectSound] };
+	m_nextEffectSound = (m_nextEffectSound + 1) % m_effectSounds.size();
 
-	// Minimum score it's possible to get for a target
-	int minScore{ 100 };
-	
-	// Time at which score will plateau
-	sf::Time lowestScoreTime{ sf::seconds(20.0f) };
-
-	// What proportion of the 'max' time did we take, normalised to the range 1 - 0
-	float proportionOfTimeTaken{ 1 - (t_timeToHit.asSeconds() / lowestScoreTime.asSeconds()) };
-
-	// Square easing function; score drops off inversely proportional to the square of the time taken
-	float scoreScale{ std::pow(proportionOfTimeTaken,2) };
-	
-	int score{ static_cast<int>(maxScore * scoreScale) };
-
-	// Put a lower cap on the score
-	return (score > minScore) ? score : minScore;
+	sound.setBuffer(t_buffer);
+	sound.setPosition(sf::Vector3f{ t_position.x, t_position.y, 0.0f });
+	sound.play();
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////
 
-void Game::shakeScreen()
+void Game::shakeScreen(float t_alpha)
 {
 	sf::View view = m_window.getDefaultView();
 
@@ -649,31 +547,108 @@ void Game::shakeScreen()
 	float offsetX = (rand() % 201 - 100) / 100.0f;
 	float offsetY = (rand() % 201 - 100) / 100.0f;
 
-	offsetX *= MAX_OFFSET * (m_trauma * m_trauma);
-	offsetY *= MAX_OFFSET * (m_trauma * m_trauma);
-
-	view.move(offsetX, offsetY);
+	offsetX *= MAX_OFFSET * (m_world.getTrauma() * m_world.getTrauma());
+	offsetY *= MAX_OFFSET * (m_world.getTrauma() * m_world.getTrauma());
 
 	// rotational shake
 	float angleOffset = (rand() % 201 - 100) / 100.0f;
 
-	angleOffset *= MAX_ANGLE * (m_trauma * m_trauma);
+	angleOffset *= MAX_ANGLE * (m_world.getTrauma() * m_world.getTrauma());
 
 	view.setRotation(angleOffset);
 
+	view.setCenter(cameraCentre(t_alpha, { offsetX, offsetY }));
+
+	m_window.setView(view);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+sf::Vector2f Game::cameraCentre(float t_alpha, sf::Vector2f t_shake) const
+{
 	// View target
-	sf::Vector2f target = (m_tank.getBase().getPosition());
+	sf::Vector2f target = (m_world.getPlayerTank().getRenderPosition(t_alpha));
 	
-	target = ((target * 0.75f) + (view.getCenter() * 0.25f));
+	// Asymptotic average of target and the (shaken) screen centre; lazy camera
+	target = ((target * 0.75f) + ((m_window.getDefaultView().getCenter() + t_shake) * 0.25f));
 
 	// Center cannot go outside of the background
 	target.x = std::clamp(target.x, ScreenSize::s_width / 2.0f, ScreenSize::s_width * 1.5f);
 	target.y = std::clamp(target.y, ScreenSize::s_height / 2.0f, ScreenSize::s_height * 1.5f);
 
-	// Asymptotic average of target and current view; lazy camera
-	view.setCenter(target);
+	return target;
+}
 
-	m_window.setView(view);
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+void Game::finishRecording()
+{
+	if (!m_recordPath.empty())
+	{
+		m_inputRecording.save(m_recordPath);
+		m_recordPath.clear();
+
+		m_world.setPerceptionBudget(AI_PERCEPTION_BUDGET);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+void Game::updateCollisionStats()
+{
+	CollisionDetector::Stats& stats = CollisionDetector::getStats();
+
+	m_collisionStatsText.setString(
+		"pairs: " + std::to_string(stats.pairsTested.load()) +
+		"\ncircle rejected: " + std::to_string(stats.circleRejected.load()) +
+		"\naabb rejected: " + std::to_string(stats.aabbRejected.load()) +
+		"\nsat rejected: " + std::to_string(stats.satRejected.load()) +
+		"\ncollisions: " + std::to_string(stats.collisions.load()));
+
+	CollisionDetector::resetStats();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+void Game::updateParticleStats()
+{
+	ParticleManager const& particles{ m_world.getParticles() };
+	ParticleSystem::Stats stats{ particles.getStats() };
+
+	m_particleStatsText.setString(
+		"particle draw calls: " + std::to_string(particles.getDrawCallCount()) +
+		"\nparticles drawn: " + std::to_string(particles.getDrawnCount()) +
+		"\nemission scale: " + std::to_string(particles.getEmissionScale()) +
+		"\ndropped at limit: " + std::to_string(stats.dropped) +
+		"\nparticle systems: " + std::to_string(stats.systems) +
+		"\nparticles: " + std::to_string(stats.particles) +
+		"\nemitters: " + std::to_string(stats.emitters) +
+		"\naffectors: " + std::to_string(stats.affectors) +
+		"\nmost affectors on one system: " + std::to_string(stats.mostAffectors));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+void Game::updateProfilerOverlay()
+{
+	// summarising sorts every held sample, so don't do it every frame
+	if (m_profilerRefreshClock.getElapsedTime() < sf::seconds(0.5f))
+	{
+		return;
+	}
+
+	m_profilerRefreshClock.restart();
+
+	std::ostringstream text;
+	text << std::fixed << std::setprecision(3) << "section  mean ms / p99 ms\n";
+
+	for (Profiler::Summary const& summary : Profiler::get().summarise())
+	{
+		text << std::string(summary.depth * 2, ' ') << summary.name << "  "
+			<< summary.meanMs << " / " << summary.p99Ms << "\n";
+	}
+
+	m_profilerText.setString(text.str());
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////
@@ -694,21 +669,10 @@ void Game::fadeDeltaScoreText()
 
 ///////////////////////////////////////////////////////////////////////////////////////////////
 
-void Game::nextTarget()
+void Game::render(float t_alpha)
 {
-	m_targetIndex++;
-
-	// take previous target out of the array
-	m_activeTargets.clear();
-
-	// add new target to the array
-	m_activeTargets.push_back(m_allTargets[m_targetIndex % m_allTargets.size()]);
-}
+	PROFILE_SCOPE("Game::render");
 
-///////////////////////////////////////////////////////////////////////////////////////////////
-
-void Game::render()
-{
 	m_window.clear(sf::Color::Black);
 
 	// LOADING
@@ -721,27 +685,26 @@ void Game::render()
 	// GAMEPLAY OR PAUSED
 	if (GameState::GamePlay == m_gameState || GameState::Paused == m_gameState)
 	{
-		m_window.draw(m_bgSprite);
-
-		for (auto& i : m_obstacles)
-		{
-			m_window.draw(i.getSprite());
-		}
+		// while paused no steps run, so hold everything at the latest one
+		float alpha{ (GameState::GamePlay == m_gameState) ? t_alpha : 1.0f };
 
-		for (auto& target : m_activeTargets)
+		if (GameState::GamePlay == m_gameState)
 		{
-			m_window.draw(target.getSprite());
+			shakeScreen(alpha);
 		}
 
-		m_tank.render(m_window);
+		m_window.draw(m_bgSprite);
 
-		m_topLeftAI.render(m_window);
-		m_topRightAI.render(m_window);
-		m_bottomLeftAI.render(m_window);
-		m_bottomRightAI.render(m_window);
+		m_world.render(m_window, alpha);
 
 		if (m_deltaScoreClock.getElapsedTime() < DELTA_SCORE_TIME) m_window.draw(m_deltaScoreText);
 
+		if (DEBUG_mode)
+		{
+			m_window.draw(m_collisionStatsText);
+			m_window.draw(m_particleStatsText);
+		}
+
 		// PAUSED
 		if (GameState::Paused == m_gameState)
 		{
@@ -756,6 +719,12 @@ void Game::render()
 	m_window.setView(m_window.getDefaultView()); 
 	m_HUD.render(m_window);
 
+	if (m_showProfiler)
+	{
+		updateProfilerOverlay();
+		m_window.draw(m_profilerText);
+	}
+
 	// Restore the view transforms
 	m_window.setView(currentView);
 
@@ -784,14 +753,3 @@ void Game::drawPauseScreen()
 
 	m_window.draw(pauseText);
 }
-
-///////////////////////////////////////////////////////////////////////////////////////////////
-
-void Game::gameOver()
-{
-	m_gameState = GameState::GameOver;
-
-	m_gameOverMusic.play();
-
-	m_tank.reset();
-}
\ No newline at end of file
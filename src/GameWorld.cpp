@@ -0,0 +1,468 @@
+#include "GameWorld.h"
+#include "Profiler.h"
+#include "MathUtility.h"
+#include <algorithm>
+
+GameWorld::GameWorld(sf::Texture const& t_spriteSheet, LevelData const& t_level, unsigned t_seed) :
+	m_level(t_level),
+	m_spriteSheetTexture(t_spriteSheet),
+	m_random(t_seed),
+	m_tank(m_spriteSheetTexture, m_spatialGrid, m_trauma, m_events, m_particles, m_random)
+{
+	generateWalls();
+	generateTargets();
+
+	// obstacles never move, so the packed cell arrays, blocked tiles and nav mesh are built once per world
+	m_spatialGrid.build(m_obstacles);
+	m_flowField.build(m_obstacles);
+	m_navMesh.build(m_obstacles, WHOLE_MAP);
+
+	// nor do their bounding boxes; fill the caches now so AI tanks checking shells on different threads only ever read them
+	for (Obstacle& obstacle : m_obstacles)
+	{
+		obstacle.getBoundingBox();
+	}
+
+	// Now the level data is loaded, set the tank position in a random corner.
+	std::uniform_int_distribution<std::size_t> spawn(0, m_level.m_tank.m_position.size() - 1);
+	m_tank.setPosition(m_level.m_tank.m_position[spawn(m_random)]);
+
+	// AI tanks register their own address with the grid, so they're built in place, never copied
+	m_aiTanks.reserve(m_level.m_aiTanks.size());
+
+	for (AiTankData const& data : m_level.m_aiTanks)
+	{
+		TankAi& ai{ m_aiTanks.emplace_back(m_spriteSheetTexture, m_spatialGrid, m_flowField, m_navMesh, m_trauma, m_events, m_particles, m_random) };
+
+		ai.setPatrolZone((data.m_patrolZone.width > 0.0f && data.m_patrolZone.height > 0.0f) ? data.m_patrolZone : WHOLE_MAP);
+	}
+}
+
+////////////////////////////////////////////////////////////
+
+void GameWorld::init()
+{
+	// Restart match clocks
+	m_gameClock.restart();
+	m_targetClock.restart();
+
+	// Reset trauma/screenshake variable
+	m_trauma = 0.0f;
+
+	// Reset score counters
+	m_targetIndex = 0;
+
+	m_gameData.totalTargets = 10;
+	m_gameData.targetsCollected = 0;
+	m_gameData.timePerTarget.clear();
+	m_gameData.score = 0;
+
+	// Clear targets array and push back first target
+	m_activeTargets.clear();
+	m_activeTargets.push_back(m_allTargets[m_targetIndex]);
+
+	registerTargets();
+
+	// last match's smoke and sparks; the player tank switches its emitters back on as it takes damage
+	m_particles.clear();
+
+	for (std::size_t i = 0; i < m_aiTanks.size(); i++)
+	{
+		m_aiTanks[i].init(m_level.m_aiTanks[i].m_position);
+	}
+
+	m_perception.reset(m_aiTanks.size());
+
+	m_events.clear();
+	m_outcome = Outcome::InProgress;
+}
+
+////////////////////////////////////////////////////////////
+
+void GameWorld::generateWalls()
+{
+	sf::IntRect wallRect;
+
+	// Create the Walls
+	for (ObstacleData const& obstacle : m_level.m_obstacles)
+	{
+		// Randomly choose one of our rock sprites
+		switch (std::uniform_int_distribution<int>(0, 2)(m_random))
+		{
+		case 0:
+			wallRect = { 48, 90, 64, 64 };
+			break;
+		case 1:
+			wallRect = { 112, 90, 96, 64 };
+			break;
+		case 2:
+			wallRect = { 48, 160, 80, 64 };
+			break;
+		default:
+			break;
+		}
+
+		// Random rotation
+		int rotation = std::uniform_int_distribution<int>(0, 359)(m_random);
+
+		sf::Sprite sprite;
+		sprite.setTexture(m_spriteSheetTexture);
+		sprite.setTextureRect(wallRect);
+		sprite.setOrigin(wallRect.width / 2.0f, wallRect.height / 2.0f);
+		sprite.setPosition(obstacle.m_position);
+		sprite.setRotation(rotation);
+
+		m_obstacles.push_back(Obstacle(sprite));
+	}
+}
+
+////////////////////////////////////////////////////////////
+
+void GameWorld::generateTargets()
+{
+	sf::IntRect targetRect(0, 90, 38, 38);
+
+	for (TargetData const& target : m_level.m_targets)
+	{
+		sf::Sprite sprite;
+		sprite.setTexture(m_spriteSheetTexture);
+		sprite.setTextureRect(targetRect);
+		sprite.setOrigin(targetRect.width / 2.0f, targetRect.height / 2.0f);
+		sprite.setPosition(target.m_position);
+
+		float offsetX = static_cast<float>(std::uniform_int_distribution<int>(0, target.m_randomOffset.x - 1)(m_random));
+		float offsetY = static_cast<float>(std::uniform_int_distribution<int>(0, target.m_randomOffset.y - 1)(m_random));
+
+		sprite.move({ offsetX, offsetY });
+
+		m_allTargets.push_back(sprite);
+	}
+}
+
+////////////////////////////////////////////////////////////
+
+void GameWorld::registerTargets()
+{
+	// the old proxies point into storage we may just have reused
+	for (int proxy : m_targetProxies)
+	{
+		m_spatialGrid.remove(proxy);
+	}
+
+	m_targetProxies.clear();
+
+	for (Target& target : m_activeTargets)
+	{
+		m_targetProxies.push_back(m_spatialGrid.insert(&target, SpatialGrid::Targets, target.getSprite().getGlobalBounds()));
+	}
+}
+
+////////////////////////////////////////////////////////////
+
+void GameWorld::applyInput(PlayerInput const& t_input, sf::Time t_dt)
+{
+	if (t_input.forward)
+	{
+		m_tank.increaseSpeed(t_dt);
+	}
+
+	if (t_input.back)
+	{
+		m_tank.decreaseSpeed(t_dt);
+	}
+
+	if (t_input.left)
+	{
+		m_tank.decreaseRotation(t_dt);
+	}
+
+	if (t_input.right)
+	{
+		m_tank.increaseRotation(t_dt);
+	}
+
+	if (t_input.toggleTurretFree)
+	{
+		m_tank.toggleTurretFree();
+	}
+
+	// Get the angle between the aim position and the tank, and assign the turret that angle
+	sf::Vector2f vec = t_input.aimPosition - m_tank.position();
+
+	m_tank.setTurretHeading(atan2(vec.y, vec.x));
+}
+
+////////////////////////////////////////////////////////////
+
+void GameWorld::update(PlayerInput const& t_input, sf::Time t_dt)
+{
+	PROFILE_SCOPE("GameWorld::update");
+
+	if (Outcome::InProgress != m_outcome)
+	{
+		return;
+	}
+
+	m_gameClock.update(t_dt);
+	m_targetClock.update(t_dt);
+
+	applyInput(t_input, t_dt);
+
+	// Check for collisions with AI tank
+	for (TankAi& ai : m_aiTanks)
+	{
+		if (ai.collidesWithPlayer(m_tank))
+		{
+			endMatch(Outcome::PlayerLost);
+			break;
+		}
+	}
+
+	if (m_gameData.targetsCollected >= m_gameData.totalTargets)
+	{
+		endMatch(Outcome::PlayerWon);
+	}
+
+	if (m_tank.getHealth() <= 0.0f)
+	{
+		endMatch(Outcome::PlayerLost);
+	}
+
+	checkTargetsHit();
+
+	m_tank.update(t_dt);
+
+	updateAiTanks(t_dt);
+
+#ifndef HEADLESS
+	// after every tank has committed, so this tick's bursts are in
+	m_particles.update(t_dt);
+#endif
+
+	// update game time for HUD
+	m_gameData.timeElapsed = m_gameClock.getElapsedTime().asSeconds();
+
+	// update player health for HUD
+	m_gameData.playerHealth = m_tank.getHealth();
+
+	// update player damage for HUD
+	m_gameData.tankDamage = m_tank.getDamage();
+
+	// reduce trauma linearly to zero
+	float decay{ TRAUMA_DECAY * t_dt.asSeconds() };
+	(m_trauma > decay) ? m_trauma -= decay : m_trauma = 0.0f;
+}
+
+////////////////////////////////////////////////////////////
+
+void GameWorld::updateAiTanks(sf::Time t_dt)
+{
+	PROFILE_SCOPE("GameWorld::updateAiTanks");
+
+	// AI shells test against the player's cached box; refresh it here so the AI updates only read it
+	m_tank.getBoundingBox();
+
+	schedulePerception();
+
+	// one field serves every chaser, so it's only worth refreshing if someone is chasing
+	for (TankAi const& ai : m_aiTanks)
+	{
+		if (TankAi::AIState::FOLLOW_PLAYER == ai.m_currentState)
+		{
+			m_flowField.update(m_tank.position());
+			break;
+		}
+	}
+
+	if (m_threadPool && m_aiTanks.size() >= MIN_PARALLEL_AI)
+	{
+		std::size_t taskCount{ std::max<std::size_t>(1, m_threadPool->getThreadCount() * AI_TASKS_PER_THREAD) };
+		std::size_t tanksPerTask{ (m_aiTanks.size() + taskCount - 1) / taskCount };
+
+		// collision counters are per thread; the workers hand theirs back to ours, where the overlay reads them
+		CollisionDetector::Stats& collisionStats{ CollisionDetector::getStats() };
+
+		for (std::size_t first = 0; first < m_aiTanks.size(); first += tanksPerTask)
+		{
+			std::size_t last{ std::min(first + tanksPerTask, m_aiTanks.size()) };
+
+			m_threadPool->submit([this, first, last, t_dt, &collisionStats]()
+			{
+				for (std::size_t i = first; i < last; i++)
+				{
+					m_aiTanks[i].update(m_tank, t_dt);
+				}
+
+				CollisionDetector::addStatsTo(collisionStats);
+			});
+		}
+
+		m_threadPool->wait();
+	}
+	else
+	{
+		for (TankAi& ai : m_aiTanks)
+		{
+			ai.update(m_tank, t_dt);
+		}
+	}
+
+	// trauma, events and hits on the player land in roster order, whichever update finished first
+	sf::Time perceptionTime;
+	unsigned perceptions{ 0 };
+
+	for (TankAi& ai : m_aiTanks)
+	{
+		ai.commit();
+
+		if (ai.isPerceiving())
+		{
+			perceptionTime += ai.getPerceptionCost();
+			perceptions++;
+		}
+	}
+
+	m_perception.reportCost(perceptionTime, perceptions);
+}
+
+////////////////////////////////////////////////////////////
+
+void GameWorld::schedulePerception()
+{
+	const bool viewKnown{ m_viewArea.width > 0.0f && m_viewArea.height > 0.0f };
+
+	m_perceptionNeeds.resize(m_aiTanks.size());
+
+	for (std::size_t i = 0; i < m_aiTanks.size(); i++)
+	{
+		TankAi& ai{ m_aiTanks[i] };
+		sf::Vector2f position{ ai.getSprite().getPosition() };
+
+		PerceptionScheduler::Need& need{ m_perceptionNeeds[i] };
+		need.engaged = (TankAi::AIState::ATTACK_PLAYER == ai.m_currentState);
+		need.distanceToPlayer = thor::length(position - m_tank.position());
+		need.onScreen = !viewKnown || m_viewArea.contains(position);
+	}
+
+	m_perception.schedule(m_perceptionNeeds, m_perceiving);
+
+	for (std::size_t i = 0; i < m_aiTanks.size(); i++)
+	{
+		m_aiTanks[i].setPerceiving(0 != m_perceiving[i]);
+	}
+}
+
+////////////////////////////////////////////////////////////
+
+void GameWorld::render(sf::RenderWindow& t_window, float t_alpha)
+{
+	for (auto& i : m_obstacles)
+	{
+		t_window.draw(i.getSprite());
+	}
+
+	if (DEBUG_mode)
+	{
+		m_navMesh.render(t_window);
+	}
+
+	for (auto& target : m_activeTargets)
+	{
+		t_window.draw(target.getSprite());
+	}
+
+	m_tank.render(t_window, t_alpha);
+
+	for (TankAi& ai : m_aiTanks)
+	{
+		ai.render(t_window, t_alpha);
+	}
+
+	t_window.draw(m_particles);
+}
+
+////////////////////////////////////////////////////////////
+
+void GameWorld::checkTargetsHit()
+{
+	// setup our new target
+	for (auto& t : m_activeTargets)
+	{
+		if (t.isHit())
+		{
+			// How long did it take the player to hit the target?
+			sf::Time targetTime{ m_targetClock.getElapsedTime() };
+			m_gameData.timePerTarget.push_back(targetTime.asSeconds());
+
+			m_targetClock.restart();
+
+			m_gameData.targetsCollected++;
+
+			int deltaScore{ calculateScore(targetTime) };
+			m_gameData.score += deltaScore;
+
+			t.reset();
+
+			m_events.push_back({ GameEvent::Type::TargetCollected, t.getSprite().getPosition(), deltaScore });
+
+			nextTarget();
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////
+
+int GameWorld::calculateScore(sf::Time t_timeToHit)
+{
+	// Maximum score it's possible to get per target
+	int maxScore{ 1000 };
+
+	// Minimum score it's possible to get for a target
+	int minScore{ 100 };
+
+	// Time at which score will plateau
+	sf::Time lowestScoreTime{ sf::seconds(20.0f) };
+
+	// What proportion of the 'max' time did we take, normalised to the range 1 - 0
+	float proportionOfTimeTaken{ 1 - (t_timeToHit.asSeconds() / lowestScoreTime.asSeconds()) };
+
+	// Square easing function; score drops off inversely proportional to the square of the time taken
+	float scoreScale{ std::pow(proportionOfTimeTaken,2) };
+
+	int score{ static_cast<int>(maxScore * scoreScale) };
+
+	// Put a lower cap on the score
+	return (score > minScore) ? score : minScore;
+}
+
+////////////////////////////////////////////////////////////
+
+void GameWorld::nextTarget()
+{
+	m_targetIndex++;
+
+	// take previous target out of the array
+	m_activeTargets.clear();
+
+	// add new target to the array
+	m_activeTargets.push_back(m_allTargets[m_targetIndex % m_allTargets.size()]);
+
+	registerTargets();
+}
+
+////////////////////////////////////////////////////////////
+
+void GameWorld::endMatch(Outcome t_outcome)
+{
+	// the first result of the tick stands
+	if (Outcome::InProgress != m_outcome)
+	{
+		return;
+	}
+
+	m_outcome = t_outcome;
+
+	m_events.push_back({ (Outcome::PlayerWon == t_outcome) ? GameEvent::Type::PlayerWon : GameEvent::Type::PlayerLost, m_tank.position() });
+
+	m_tank.reset();
+}
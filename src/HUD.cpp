@@ -1,4 +1,5 @@
 #include "HUD.h"
+#include "Profiler.h"
 
 ////////////////////////////////////////////////////////////
 HUD::HUD(sf::Font& hudFont, GameData& t_gameData, GameState& t_state) :
@@ -106,6 +107,8 @@ void HUD::update()
 
 void HUD::render(sf::RenderWindow& t_window)
 {
+	PROFILE_SCOPE("HUD::render");
+
 	t_window.draw(m_hudOutline);
 	t_window.draw(m_hudBackground);
 
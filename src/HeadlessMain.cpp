@@ -0,0 +1,79 @@
+#ifdef _DEBUG 
+#pragma comment(lib,"sfml-graphics-d.lib") 
+#pragma comment(lib,"sfml-system-d.lib") 
+#pragma comment(lib,"thor-d.lib")
+#else 
+#pragma comment(lib,"sfml-graphics.lib") 
+#pragma comment(lib,"sfml-system.lib") 
+#pragma comment(lib,"thor.lib")
+#endif 
+
+#pragma comment(lib,"libyaml-cppmdd")
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include "BatchRunner.h"
+#include "Profiler.h"
+
+/// <summary>
+/// @brief starting point for the headless simulation runner.
+/// 
+/// Plays a batch of matches with no window, no audio and an empty sprite sheet, spread across a
+/// work-stealing thread pool. Each match steps at a fixed rate (the script's, or 60Hz) as fast as the
+/// machine allows until it is decided or hits the tick limit, then a per-match and aggregate report is printed.
+/// 
+/// Usage: SFML_Headless [inputScript] [maxTicks] [firstSeed] [matches] [threads]
+/// Pass "-" for no script, in which case the player tank sits still. A script recorded with
+/// "SFML_Playground --record" replays that player's input in every match. Match n is seeded with
+/// firstSeed + n, so the same arguments always produce the same report. Leave out firstSeed, or pass
+/// "-", to start from the seed the script was recorded with; match 0 then replays the recorded match.
+/// </summary>
+/// <param name="argc"></param>
+/// <param name="argv"></param>
+/// <returns>0 on success, 1 if the level or script couldn't be loaded</returns>
+int main(int argc, char* argv[])
+{
+	std::string scriptPath{ (argc > 1) ? argv[1] : "-" };
+	unsigned maxTicks{ (argc > 2) ? static_cast<unsigned>(std::stoul(argv[2])) : 60U * 60U * 5U };
+	std::string firstSeedArg{ (argc > 3) ? argv[3] : "-" };
+	unsigned matches{ (argc > 4) ? static_cast<unsigned>(std::stoul(argv[4])) : 1U };
+	unsigned threads{ (argc > 5) ? static_cast<unsigned>(std::stoul(argv[5])) : 0U };
+
+	InputScript script;
+	LevelData level;
+
+	try
+	{
+		if ("-" != scriptPath)
+		{
+			script.load(scriptPath);
+		}
+
+		LevelLoader::load(1, level);
+	}
+	catch (std::exception& e)
+	{
+		std::cout << e.what() << std::endl;
+		return 1;
+	}
+
+	// an empty script's seed is 0, as it always was
+	unsigned firstSeed{ ("-" == firstSeedArg) ? script.getSeed() : static_cast<unsigned>(std::stoul(firstSeedArg)) };
+
+	ThreadPool pool(threads);
+	BatchRunner runner(level, script, maxTicks);
+
+	auto start = std::chrono::steady_clock::now();
+	std::vector<MatchResult> results{ runner.run(matches, firstSeed, pool) };
+	std::chrono::duration<double> wallTime{ std::chrono::steady_clock::now() - start };
+
+	BatchRunner::report(results, std::cout);
+
+	std::cout << "threads: " << pool.getThreadCount() << "\nwall time: " << wallTime.count() << "s" << std::endl;
+
+	Profiler::get().writeCsv("profile.csv");
+	Profiler::get().writeJson("profile.json");
+
+	return 0;
+}
@@ -0,0 +1,126 @@
+#include "InputScript.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+	bool sameInput(PlayerInput const& t_a, PlayerInput const& t_b)
+	{
+		return t_a.forward == t_b.forward && t_a.back == t_b.back &&
+			t_a.left == t_b.left && t_a.right == t_b.right &&
+			t_a.toggleTurretFree == t_b.toggleTurretFree &&
+			t_a.aimPosition == t_b.aimPosition;
+	}
+}
+
+////////////////////////////////////////////////////////////
+
+void InputScript::load(std::string const& t_path)
+{
+	std::ifstream file(t_path);
+
+	if (!file.is_open())
+	{
+		throw std::runtime_error("Could not open input script " + t_path);
+	}
+
+	m_entries.clear();
+	m_seed = 0;
+	m_updateRate = 60;
+
+	std::string line;
+
+	while (std::getline(file, line))
+	{
+		if (line.empty() || '#' == line[0]) continue;
+
+		std::istringstream stream(line);
+
+		if (0 == line.compare(0, 5, "seed "))
+		{
+			std::string seedKey;
+			std::string rateKey;
+
+			stream >> seedKey >> m_seed >> rateKey >> m_updateRate;
+
+			if (stream.fail() || "hz" != rateKey || 0 == m_updateRate)
+			{
+				throw std::runtime_error("Malformed header in input script " + t_path + ": " + line);
+			}
+
+			continue;
+		}
+
+		Entry entry;
+
+		stream >> entry.tick
+			>> entry.input.forward >> entry.input.back
+			>> entry.input.left >> entry.input.right
+			>> entry.input.toggleTurretFree
+			>> entry.input.aimPosition.x >> entry.input.aimPosition.y;
+
+		if (stream.fail())
+		{
+			throw std::runtime_error("Malformed line in input script " + t_path + ": " + line);
+		}
+
+		m_entries.push_back(entry);
+	}
+
+	// getInput() relies on the entries being in tick order
+	std::stable_sort(m_entries.begin(), m_entries.end(), [](Entry const& t_a, Entry const& t_b) { return t_a.tick < t_b.tick; });
+}
+
+////////////////////////////////////////////////////////////
+
+void InputScript::save(std::string const& t_path) const
+{
+	std::ofstream file(t_path);
+
+	if (!file.is_open())
+	{
+		throw std::runtime_error("Could not write input script " + t_path);
+	}
+
+	file << "seed " << m_seed << " hz " << m_updateRate << '\n';
+	file << "# tick forward back left right toggleTurretFree aimX aimY\n";
+
+	for (Entry const& entry : m_entries)
+	{
+		file << entry.tick << ' '
+			<< entry.input.forward << ' ' << entry.input.back << ' '
+			<< entry.input.left << ' ' << entry.input.right << ' '
+			<< entry.input.toggleTurretFree << ' '
+			<< entry.input.aimPosition.x << ' ' << entry.input.aimPosition.y << '\n';
+	}
+}
+
+////////////////////////////////////////////////////////////
+
+void InputScript::record(unsigned t_tick, PlayerInput const& t_input)
+{
+	if (!m_entries.empty() && sameInput(m_entries.back().input, t_input))
+	{
+		return;
+	}
+
+	m_entries.push_back({ t_tick, t_input });
+}
+
+////////////////////////////////////////////////////////////
+
+PlayerInput InputScript::getInput(unsigned t_tick) const
+{
+	// first entry after this tick; the one before it is in effect
+	auto it = std::upper_bound(m_entries.begin(), m_entries.end(), t_tick,
+		[](unsigned t_value, Entry const& t_entry) { return t_value < t_entry.tick; });
+
+	if (it == m_entries.begin())
+	{
+		return PlayerInput();
+	}
+
+	return std::prev(it)->input;
+}
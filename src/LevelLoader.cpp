@@ -1,4 +1,5 @@
 #include "LevelLoader.h"
+#include <stdexcept>
 
 /// The various operator >> overloads below are non-member functions used to extract
 ///  the game data from the YAML data structure.
@@ -68,10 +69,37 @@ void operator >> (const YAML::Node& tankNode, TankData& tank)
 		i++;
 	}*/
 
+	tank.m_position.clear();
+
 	for (unsigned i = 0; i < tankPosNode.size(); ++i)
 	{
-		tank.m_position[i].x = tankPosNode[i]["pos"]["x"].as<float>();
-		tank.m_position[i].y = tankPosNode[i]["pos"]["y"].as<float>();
+		tank.m_position.push_back({ tankPosNode[i]["pos"]["x"].as<float>(), tankPosNode[i]["pos"]["y"].as<float>() });
+	}
+
+	if (tank.m_position.empty())
+	{
+		throw std::runtime_error("Level has no player tank spawns");
+	}
+}
+
+////////////////////////////////////////////////////////////
+
+/// <summary>
+/// @brief Extracts an AI tank's spawn position and optional patrol zone.
+/// </summary>
+/// <param name="t_spawnNode">A YAML node</param>
+/// <param name="t_aiTank">A struct holding our AI tank data</param>
+void operator >> (const YAML::Node& t_spawnNode, AiTankData& t_aiTank)
+{
+	t_aiTank.m_position.x = t_spawnNode["pos"]["x"].as<float>();
+	t_aiTank.m_position.y = t_spawnNode["pos"]["y"].as<float>();
+
+	if (t_spawnNode["patrol"])
+	{
+		t_aiTank.m_patrolZone.left = t_spawnNode["patrol"]["x"].as<float>();
+		t_aiTank.m_patrolZone.top = t_spawnNode["patrol"]["y"].as<float>();
+		t_aiTank.m_patrolZone.width = t_spawnNode["patrol"]["width"].as<float>();
+		t_aiTank.m_patrolZone.height = t_spawnNode["patrol"]["height"].as<float>();
 	}
 }
 
@@ -91,7 +119,14 @@ void operator >> (const YAML::Node& levelNode, LevelData& level)
 
 	levelNode["tank"] >> level.m_tank;
 
-	levelNode["ai_tank"] >> level.m_aiTank;
+	// One AI tank per spawn point
+	const YAML::Node& aiSpawnsNode = levelNode["ai_tank"]["spawns"].as<YAML::Node>();
+	for (unsigned i = 0; i < aiSpawnsNode.size(); ++i)
+	{
+		AiTankData aiTank;
+		aiSpawnsNode[i] >> aiTank;
+		level.m_aiTanks.push_back(aiTank);
+	}
 
 	// Load our obstacle data from file into our struct, and push a copy into our obstacle vector
 	const YAML::Node& obstaclesNode = levelNode["obstacles"].as<YAML::Node>();
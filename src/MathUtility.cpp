@@ -1,4 +1,5 @@
 #include "MathUtility.h"
+#include <cmath>
 
 namespace MathUtility
 {
@@ -18,10 +19,15 @@ namespace MathUtility
 
 	////////////////////////////////////////////////////////////
 	
-	bool lineIntersectsCircle(sf::Vector2f ahead, sf::Vector2f halfAhead, sf::CircleShape circle)
+	bool lineIntersectsCircle(sf::Vector2f ahead, sf::Vector2f halfAhead, sf::Vector2f centre, float radius)
 	{
-		return distance(circle.getPosition(), ahead) <= circle.getRadius() ||
-			distance(circle.getPosition(), halfAhead) <= circle.getRadius();
+		// compare squared distances, no square roots needed
+		sf::Vector2f toAhead = ahead - centre;
+		sf::Vector2f toHalfAhead = halfAhead - centre;
+		float radiusSquared = radius * radius;
+
+		return toAhead.x * toAhead.x + toAhead.y * toAhead.y <= radiusSquared ||
+			toHalfAhead.x * toHalfAhead.x + toHalfAhead.y * toHalfAhead.y <= radiusSquared;
 	}
 
 	////////////////////////////////////////////////////////////
@@ -37,4 +43,68 @@ namespace MathUtility
 		return v;
 	}
 
+	////////////////////////////////////////////////////////////
+
+	float rayCircleIntersection(sf::Vector2f origin, sf::Vector2f direction, sf::Vector2f centre, float radius)
+	{
+		sf::Vector2f toCentre = centre - origin;
+
+		// distance along the ray to the point closest to the centre, and the squared distance between the two
+		float along = toCentre.x * direction.x + toCentre.y * direction.y;
+		float missSquared = toCentre.x * toCentre.x + toCentre.y * toCentre.y - along * along;
+
+		if (missSquared > radius * radius)
+		{
+			return INFINITY;
+		}
+
+		float halfChord = std::sqrt(radius * radius - missSquared);
+
+		// behind us entirely
+		if (along + halfChord < 0.0f)
+		{
+			return INFINITY;
+		}
+
+		return std::max(along - halfChord, 0.0f);
+	}
+
+	////////////////////////////////////////////////////////////
+
+	sf::FloatRect unite(sf::FloatRect const& a, sf::FloatRect const& b)
+	{
+		float left = std::min(a.left, b.left);
+		float top = std::min(a.top, b.top);
+		float right = std::max(a.left + a.width, b.left + b.width);
+		float bottom = std::max(a.top + a.height, b.top + b.height);
+
+		return { left, top, right - left, bottom - top };
+	}
+
+	////////////////////////////////////////////////////////////
+
+	sf::Vector2f lerp(sf::Vector2f a, sf::Vector2f b, float t)
+	{
+		return a + (b - a) * t;
+	}
+
+	////////////////////////////////////////////////////////////
+
+	float lerpAngle(float a, float b, float t)
+	{
+		// wrap the difference into [-180, 180) so 350 -> 10 turns 20 degrees, not 340
+		float difference = std::fmod(b - a, 360.0f);
+
+		if (difference >= 180.0f)
+		{
+			difference -= 360.0f;
+		}
+		else if (difference < -180.0f)
+		{
+			difference += 360.0f;
+		}
+
+		return a + difference * t;
+	}
+
 }
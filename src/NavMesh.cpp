@@ -0,0 +1,619 @@
+#include "NavMesh.h"
+#include "Profiler.h"
+#include <Thor/Math/Triangulation.hpp>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iterator>
+
+namespace
+{
+	/// <summary>
+	/// @brief An obstacle's box grown outward on every side
+	/// </summary>
+	struct GrownBox
+	{
+		std::array<sf::Vector2f, 4> corners;
+		sf::Vector2f axes[2]; // unit edge directions
+		sf::FloatRect bounds;
+	};
+
+	// Triangles are only thrown away for overlapping a box this much smaller than the grown one,
+	// so triangles that merely touch a grown box along an edge or at a corner are kept
+	const float OVERLAP_TOLERANCE{ 1.0f };
+
+	float cross(sf::Vector2f t_a, sf::Vector2f t_b)
+	{
+		return t_a.x * t_b.y - t_a.y * t_b.x;
+	}
+
+	float dot(sf::Vector2f t_a, sf::Vector2f t_b)
+	{
+		return t_a.x * t_b.x + t_a.y * t_b.y;
+	}
+
+	float distance(sf::Vector2f t_a, sf::Vector2f t_b)
+	{
+		sf::Vector2f gap{ t_b - t_a };
+
+		return std::sqrt(dot(gap, gap));
+	}
+
+	/// <summary>
+	/// @brief Grows an obstacle's box outward from its centre by the given margin on every side
+	/// </summary>
+	GrownBox grow(OrientedBoundingBox const& t_box, float t_margin)
+	{
+		GrownBox grown;
+		sf::Vector2f centre{ (t_box.Points[0] + t_box.Points[1] + t_box.Points[2] + t_box.Points[3]) / 4.0f };
+
+		for (int i = 0; i < 2; i++)
+		{
+			float length{ std::sqrt(dot(t_box.Axes[i], t_box.Axes[i])) };
+			grown.axes[i] = (length > 0.0f) ? t_box.Axes[i] / length : sf::Vector2f{ static_cast<float>(1 - i), static_cast<float>(i) };
+		}
+
+		for (int i = 0; i < 4; i++)
+		{
+			sf::Vector2f corner{ t_box.Points[i] };
+			sf::Vector2f outward{ corner - centre };
+
+			for (sf::Vector2f const& axis : grown.axes)
+			{
+				corner += axis * ((dot(outward, axis) > 0.0f) ? t_margin : -t_margin);
+			}
+
+			grown.corners[i] = corner;
+		}
+
+		float left{ grown.corners[0].x }, right{ grown.corners[0].x };
+		float top{ grown.corners[0].y }, bottom{ grown.corners[0].y };
+
+		for (sf::Vector2f const& corner : grown.corners)
+		{
+			left = std::min(left, corner.x);
+			right = std::max(right, corner.x);
+			top = std::min(top, corner.y);
+			bottom = std::max(bottom, corner.y);
+		}
+
+		grown.bounds = { left, top, right - left, bottom - top };
+
+		return grown;
+	}
+
+	/// <summary>
+	/// @brief Projects some points onto an axis and returns the outermost two
+	/// </summary>
+	template <std::size_t N>
+	void project(std::array<sf::Vector2f, N> const& t_points, sf::Vector2f t_axis, float& t_min, float& t_max)
+	{
+		t_min = t_max = dot(t_points[0], t_axis);
+
+		for (std::size_t i = 1; i < N; i++)
+		{
+			float projection{ dot(t_points[i], t_axis) };
+			t_min = std::min(t_min, projection);
+			t_max = std::max(t_max, projection);
+		}
+	}
+
+	/// <summary>
+	/// @brief Whether a point is inside a grown box
+	/// </summary>
+	bool inside(sf::Vector2f t_point, GrownBox const& t_box)
+	{
+		if (!t_box.bounds.contains(t_point))
+		{
+			return false;
+		}
+
+		for (sf::Vector2f const& axis : t_box.axes)
+		{
+			float min, max;
+			project(t_box.corners, axis, min, max);
+
+			float projection{ dot(t_point, axis) };
+
+			if (projection <= min || projection >= max)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	/// <summary>
+	/// @brief Separating axis test between a triangle and a grown box
+	/// </summary>
+	bool overlaps(std::array<sf::Vector2f, 3> const& t_triangle, GrownBox const& t_box)
+	{
+		sf::Vector2f axes[5]{ t_box.axes[0], t_box.axes[1] };
+
+		for (int i = 0; i < 3; i++)
+		{
+			sf::Vector2f edge{ t_triangle[(i + 1) % 3] - t_triangle[i] };
+			axes[2 + i] = { -edge.y, edge.x };
+		}
+
+		for (sf::Vector2f const& axis : axes)
+		{
+			float triangleMin, triangleMax, boxMin, boxMax;
+			project(t_triangle, axis, triangleMin, triangleMax);
+			project(t_box.corners, axis, boxMin, boxMax);
+
+			if (triangleMax <= boxMin || boxMax <= triangleMin)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+}
+
+////////////////////////////////////////////////////////////
+
+void NavMesh::build(std::vector<Obstacle>& t_obstacles, sf::FloatRect t_bounds)
+{
+	PROFILE_SCOPE("NavMesh::build");
+
+	m_bounds = t_bounds;
+	m_vertices.clear();
+	m_triangles.clear();
+
+	// Vertices go on the grown boxes; triangles are tested against slightly smaller ones
+	std::vector<GrownBox> grown;
+	std::vector<GrownBox> blockers;
+
+	for (Obstacle& obstacle : t_obstacles)
+	{
+		OrientedBoundingBox const& box{ obstacle.getBoundingBox() };
+
+		grown.push_back(grow(box, CLEARANCE));
+		blockers.push_back(grow(box, CLEARANCE - OVERLAP_TOLERANCE));
+	}
+
+	auto blocked = [&blockers](sf::Vector2f t_point)
+	{
+		return std::any_of(blockers.begin(), blockers.end(), [t_point](GrownBox const& t_box) { return inside(t_point, t_box); });
+	};
+
+	// points round the outline of every grown box, except where it's buried in a neighbouring rock;
+	// rocks overlap in long chains, and the corners alone would leave the chain's sides bare
+	for (GrownBox const& box : grown)
+	{
+		for (int i = 0; i < 4; i++)
+		{
+			sf::Vector2f from{ box.corners[i] };
+			sf::Vector2f edge{ box.corners[(i + 1) % 4] - from };
+			int steps{ std::max(1, static_cast<int>(std::ceil(std::sqrt(dot(edge, edge)) / OUTLINE_SPACING))) };
+
+			for (int step = 0; step < steps; step++)
+			{
+				sf::Vector2f point{ from + edge * (static_cast<float>(step) / steps) };
+
+				if (m_bounds.contains(point) && !blocked(point))
+				{
+					m_vertices.push_back(point);
+				}
+			}
+		}
+	}
+
+	// and a lattice over the open ground, reaching right to the edges of the bounds so the mesh covers them
+	int latticeCols{ static_cast<int>(std::ceil(m_bounds.width / LATTICE_SPACING)) };
+	int latticeRows{ static_cast<int>(std::ceil(m_bounds.height / LATTICE_SPACING)) };
+
+	for (int row = 0; row <= latticeRows; row++)
+	{
+		for (int col = 0; col <= latticeCols; col++)
+		{
+			sf::Vector2f point{
+				m_bounds.left + std::min(col * LATTICE_SPACING, m_bounds.width),
+				m_bounds.top + std::min(row * LATTICE_SPACING, m_bounds.height) };
+
+			if (!blocked(point))
+			{
+				m_vertices.push_back(point);
+			}
+		}
+	}
+
+	// the triangulation can't cope with two vertices in the same place
+	std::sort(m_vertices.begin(), m_vertices.end(), [](sf::Vector2f const& a, sf::Vector2f const& b)
+	{
+		return (a.x != b.x) ? a.x < b.x : a.y < b.y;
+	});
+
+	m_vertices.erase(std::unique(m_vertices.begin(), m_vertices.end()), m_vertices.end());
+
+	std::vector<thor::Triangle<sf::Vector2f>> triangulation;
+	thor::triangulate(m_vertices.begin(), m_vertices.end(), std::back_inserter(triangulation));
+
+	for (thor::Triangle<sf::Vector2f> const& triangle : triangulation)
+	{
+		Triangle walkable;
+		std::array<sf::Vector2f, 3> points;
+
+		for (int i = 0; i < 3; i++)
+		{
+			walkable.corners[i] = static_cast<int>(&triangle[i] - m_vertices.data());
+			points[i] = triangle[i];
+		}
+
+		float area{ cross(points[1] - points[0], points[2] - points[0]) };
+
+		if (std::abs(area) < 1.0f) continue;
+
+		// keep one winding, so the funnel can tell left from right
+		if (area < 0.0f)
+		{
+			std::swap(walkable.corners[1], walkable.corners[2]);
+			std::swap(points[1], points[2]);
+		}
+
+		sf::FloatRect bounds{
+			std::min({ points[0].x, points[1].x, points[2].x }),
+			std::min({ points[0].y, points[1].y, points[2].y }), 0.0f, 0.0f };
+		bounds.width = std::max({ points[0].x, points[1].x, points[2].x }) - bounds.left;
+		bounds.height = std::max({ points[0].y, points[1].y, points[2].y }) - bounds.top;
+
+		bool covered{ std::any_of(blockers.begin(), blockers.end(), [&](GrownBox const& t_box)
+		{
+			return t_box.bounds.intersects(bounds) && overlaps(points, t_box);
+		}) };
+
+		if (covered) continue;
+
+		walkable.centre = (points[0] + points[1] + points[2]) / 3.0f;
+		m_triangles.push_back(walkable);
+	}
+
+	// Link triangles sharing an edge: sort every edge by its vertices, so the two sides of a shared edge end up next to each other
+	struct EdgeRef
+	{
+		std::uint64_t key;
+		int triangle;
+		int edge;
+	};
+
+	std::vector<EdgeRef> edges;
+	edges.reserve(m_triangles.size() * 3);
+
+	for (std::size_t i = 0; i < m_triangles.size(); i++)
+	{
+		for (int edge = 0; edge < 3; edge++)
+		{
+			std::uint64_t a{ static_cast<std::uint64_t>(m_triangles[i].corners[edge]) };
+			std::uint64_t b{ static_cast<std::uint64_t>(m_triangles[i].corners[(edge + 1) % 3]) };
+
+			edges.push_back({ (std::min(a, b) << 32) | std::max(a, b), static_cast<int>(i), edge });
+		}
+	}
+
+	std::sort(edges.begin(), edges.end(), [](EdgeRef const& a, EdgeRef const& b) { return a.key < b.key; });
+
+	for (std::size_t i = 1; i < edges.size(); i++)
+	{
+		if (edges[i].key == edges[i - 1].key)
+		{
+			m_triangles[edges[i].triangle].neighbours[edges[i].edge] = edges[i - 1].triangle;
+			m_triangles[edges[i - 1].triangle].neighbours[edges[i - 1].edge] = edges[i].triangle;
+		}
+	}
+
+	// Bucket the triangles by the squares their bounds overlap
+	m_bucketCols = std::max(1, static_cast<int>(std::ceil(m_bounds.width / BUCKET_SIZE)));
+	m_bucketRows = std::max(1, static_cast<int>(std::ceil(m_bounds.height / BUCKET_SIZE)));
+	m_buckets.assign(static_cast<std::size_t>(m_bucketCols * m_bucketRows), {});
+
+	for (std::size_t i = 0; i < m_triangles.size(); i++)
+	{
+		sf::Vector2f const& a{ m_vertices[m_triangles[i].corners[0]] };
+		sf::Vector2f const& b{ m_vertices[m_triangles[i].corners[1]] };
+		sf::Vector2f const& c{ m_vertices[m_triangles[i].corners[2]] };
+
+		int first{ getBucket({ std::min({ a.x, b.x, c.x }), std::min({ a.y, b.y, c.y }) }) };
+		int last{ getBucket({ std::max({ a.x, b.x, c.x }), std::max({ a.y, b.y, c.y }) }) };
+
+		for (int row = first / m_bucketCols; row <= last / m_bucketCols; row++)
+		{
+			for (int col = first % m_bucketCols; col <= last % m_bucketCols; col++)
+			{
+				m_buckets[row * m_bucketCols + col].push_back(static_cast<int>(i));
+			}
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(m_cacheMutex);
+	m_corridors.clear();
+}
+
+////////////////////////////////////////////////////////////
+
+int NavMesh::getBucket(sf::Vector2f t_position) const
+{
+	int col{ std::clamp(static_cast<int>((t_position.x - m_bounds.left) / BUCKET_SIZE), 0, m_bucketCols - 1) };
+	int row{ std::clamp(static_cast<int>((t_position.y - m_bounds.top) / BUCKET_SIZE), 0, m_bucketRows - 1) };
+
+	return row * m_bucketCols + col;
+}
+
+////////////////////////////////////////////////////////////
+
+int NavMesh::findTriangle(sf::Vector2f t_position) const
+{
+	if (m_buckets.empty() || !m_bounds.contains(t_position))
+	{
+		return -1;
+	}
+
+	for (int index : m_buckets[getBucket(t_position)])
+	{
+		Triangle const& triangle{ m_triangles[index] };
+		bool within{ true };
+
+		for (int i = 0; i < 3 && within; i++)
+		{
+			sf::Vector2f const& from{ m_vertices[triangle.corners[i]] };
+			sf::Vector2f const& to{ m_vertices[triangle.corners[(i + 1) % 3]] };
+
+			within = cross(to - from, t_position - from) >= 0.0f;
+		}
+
+		if (within)
+		{
+			return index;
+		}
+	}
+
+	return -1;
+}
+
+////////////////////////////////////////////////////////////
+
+int NavMesh::findNearestTriangle(sf::Vector2f t_position) const
+{
+	int nearest{ findTriangle(t_position) };
+
+	if (nearest != -1)
+	{
+		return nearest;
+	}
+
+	float nearestDistance{ INFINITY };
+
+	for (std::size_t i = 0; i < m_triangles.size(); i++)
+	{
+		float centreDistance{ distance(t_position, m_triangles[i].centre) };
+
+		if (centreDistance < nearestDistance)
+		{
+			nearestDistance = centreDistance;
+			nearest = static_cast<int>(i);
+		}
+	}
+
+	return nearest;
+}
+
+////////////////////////////////////////////////////////////
+
+bool NavMesh::findPath(sf::Vector2f t_start, sf::Vector2f t_goal, std::vector<sf::Vector2f>& t_path) const
+{
+	t_path.clear();
+
+	int start{ findNearestTriangle(t_start) };
+	int goal{ findTriangle(t_goal) };
+
+	if (start == -1 || goal == -1)
+	{
+		return false;
+	}
+
+	std::uint64_t key{ (static_cast<std::uint64_t>(start) << 32) | static_cast<std::uint64_t>(goal) };
+	std::vector<int> corridor;
+	bool cached{ false };
+
+	{
+		std::lock_guard<std::mutex> lock(m_cacheMutex);
+		auto found{ m_corridors.find(key) };
+
+		if (found != m_corridors.end())
+		{
+			corridor = found->second;
+			cached = true;
+		}
+	}
+
+	// search outside the lock; two threads racing for the same pair just find the same corridor twice
+	if (!cached)
+	{
+		findCorridor(start, goal, corridor);
+
+		std::lock_guard<std::mutex> lock(m_cacheMutex);
+
+		if (m_corridors.size() >= MAX_CACHED_CORRIDORS)
+		{
+			m_corridors.clear();
+		}
+
+		m_corridors.emplace(key, corridor);
+	}
+
+	if (corridor.empty())
+	{
+		return false;
+	}
+
+	funnel(t_start, t_goal, corridor, t_path);
+
+	return true;
+}
+
+////////////////////////////////////////////////////////////
+
+void NavMesh::findCorridor(int t_start, int t_goal, std::vector<int>& t_corridor) const
+{
+	PROFILE_SCOPE("NavMesh::findCorridor");
+
+	t_corridor.clear();
+
+	std::vector<float> cost(m_triangles.size(), INFINITY);
+	std::vector<int> cameFrom(m_triangles.size(), -1);
+	std::vector<char> expanded(m_triangles.size(), 0);
+	std::vector<std::pair<float, int>> open;
+
+	auto byEstimate = std::greater<std::pair<float, int>>();
+	sf::Vector2f const& goalCentre{ m_triangles[t_goal].centre };
+
+	cost[t_start] = 0.0f;
+	open.push_back({ distance(m_triangles[t_start].centre, goalCentre), t_start });
+
+	while (!open.empty())
+	{
+		std::pop_heap(open.begin(), open.end(), byEstimate);
+		int current{ open.back().second };
+		open.pop_back();
+
+		if (current == t_goal)
+		{
+			break;
+		}
+
+		// a cheaper route to this triangle was already expanded
+		if (expanded[current]) continue;
+
+		expanded[current] = 1;
+
+		for (int next : m_triangles[current].neighbours)
+		{
+			if (next == -1) continue;
+
+			float nextCost{ cost[current] + distance(m_triangles[current].centre, m_triangles[next].centre) };
+
+			if (nextCost < cost[next])
+			{
+				cost[next] = nextCost;
+				cameFrom[next] = current;
+				open.push_back({ nextCost + distance(m_triangles[next].centre, goalCentre), next });
+				std::push_heap(open.begin(), open.end(), byEstimate);
+			}
+		}
+	}
+
+	if (t_start != t_goal && cameFrom[t_goal] == -1)
+	{
+		return;
+	}
+
+	for (int triangle = t_goal; triangle != -1; triangle = cameFrom[triangle])
+	{
+		t_corridor.push_back(triangle);
+	}
+
+	std::reverse(t_corridor.begin(), t_corridor.end());
+}
+
+////////////////////////////////////////////////////////////
+
+void NavMesh::funnel(sf::Vector2f t_start, sf::Vector2f t_goal, std::vector<int> const& t_corridor, std::vector<sf::Vector2f>& t_path) const
+{
+	// The edges crossed on the way, as (left, right) seen travelling through them; a point at each end
+	std::vector<std::pair<sf::Vector2f, sf::Vector2f>> portals;
+	portals.reserve(t_corridor.size() + 1);
+	portals.push_back({ t_start, t_start });
+
+	for (std::size_t i = 0; i + 1 < t_corridor.size(); i++)
+	{
+		Triangle const& from{ m_triangles[t_corridor[i]] };
+
+		for (int edge = 0; edge < 3; edge++)
+		{
+			if (from.neighbours[edge] == t_corridor[i + 1])
+			{
+				// leaving through an edge of a positively wound triangle, its second corner is on the left
+				portals.push_back({ m_vertices[from.corners[(edge + 1) % 3]], m_vertices[from.corners[edge]] });
+				break;
+			}
+		}
+	}
+
+	portals.push_back({ t_goal, t_goal });
+
+	// Narrow a funnel from the apex through each portal in turn; when one side would cross
+	// the other, the corner on that side is part of the route and becomes the new apex
+	sf::Vector2f apex{ t_start };
+	sf::Vector2f left{ t_start };
+	sf::Vector2f right{ t_start };
+	std::size_t apexIndex{ 0 }, leftIndex{ 0 }, rightIndex{ 0 };
+
+	for (std::size_t i = 1; i < portals.size(); i++)
+	{
+		sf::Vector2f const& portalLeft{ portals[i].first };
+		sf::Vector2f const& portalRight{ portals[i].second };
+
+		// does the right side move inward?
+		if (cross(right - apex, portalRight - apex) >= 0.0f)
+		{
+			if (apex == right || cross(left - apex, portalRight - apex) < 0.0f)
+			{
+				right = portalRight;
+				rightIndex = i;
+			}
+			else
+			{
+				// it crossed the left side, so the route turns round the left corner
+				t_path.push_back(left);
+				apex = right = left;
+				apexIndex = rightIndex = leftIndex;
+				i = apexIndex;
+				continue;
+			}
+		}
+
+		// does the left side move inward?
+		if (cross(left - apex, portalLeft - apex) <= 0.0f)
+		{
+			if (apex == left || cross(right - apex, portalLeft - apex) > 0.0f)
+			{
+				left = portalLeft;
+				leftIndex = i;
+			}
+			else
+			{
+				t_path.push_back(right);
+				apex = left = right;
+				apexIndex = leftIndex = rightIndex;
+				i = apexIndex;
+				continue;
+			}
+		}
+	}
+
+	if (t_path.empty() || t_path.back() != t_goal)
+	{
+		t_path.push_back(t_goal);
+	}
+}
+
+////////////////////////////////////////////////////////////
+
+void NavMesh::render(sf::RenderWindow& t_window) const
+{
+	sf::VertexArray outline(sf::Lines);
+	sf::Color colour{ 0, 255, 128, 96 };
+
+	for (Triangle const& triangle : m_triangles)
+	{
+		for (int i = 0; i < 3; i++)
+		{
+			outline.append({ m_vertices[triangle.corners[i]], colour });
+			outline.append({ m_vertices[triangle.corners[(i + 1) % 3]], colour });
+		}
+	}
+
+	t_window.draw(outline);
+}
@@ -1,9 +1,15 @@
 #include "OrientedBoundingBox.h"
+#include <algorithm>
+#include <cmath>
 
 OrientedBoundingBox::OrientedBoundingBox(const sf::Sprite& Object) // Calculate the four points of the OBB from a transformed (scaled, rotated...) RectangleShape
+{
+	Update(Object);
+}
+
+void OrientedBoundingBox::Update(const sf::Sprite& Object) // Recalculate the points, axes and bounds from the sprite's current transform
 {
 	sf::Transform trans = Object.getTransform();
-	sf::IntRect local = Object.getTextureRect();
 
 	float width = Object.getLocalBounds().width;
 	float height = Object.getLocalBounds().height;
@@ -13,9 +19,47 @@ OrientedBoundingBox::OrientedBoundingBox(const sf::Sprite& Object) // Calculate
 	Points[1] = trans.transformPoint(width, 0.f);
 	Points[2] = trans.transformPoint(width, height);
 	Points[3] = trans.transformPoint(0.f, height);
+
+	Axes[0] = Points[1] - Points[0];
+	Axes[1] = Points[3] - Points[0];
+
+	float left = std::min(std::min(Points[0].x, Points[1].x), std::min(Points[2].x, Points[3].x));
+	float top = std::min(std::min(Points[0].y, Points[1].y), std::min(Points[2].y, Points[3].y));
+	float right = std::max(std::max(Points[0].x, Points[1].x), std::max(Points[2].x, Points[3].x));
+	float bottom = std::max(std::max(Points[0].y, Points[1].y), std::max(Points[2].y, Points[3].y));
+
+	Bounds = sf::FloatRect(left, top, right - left, bottom - top);
+
+	sf::Vector2f Diagonal = Points[2] - Points[0];
+	Centre = Points[0] + Diagonal * 0.5f;
+	Radius = std::sqrt(Diagonal.x*Diagonal.x + Diagonal.y*Diagonal.y) * 0.5f;
+
+	Valid = true;
+	Position = Object.getPosition();
+	Rotation = Object.getRotation();
+	Scale = Object.getScale();
+	Origin = Object.getOrigin();
+	Size = sf::Vector2f(width, height);
 }
 
-void OrientedBoundingBox::ProjectOntoAxis(const sf::Vector2f& Axis, float& Min, float& Max) // Project all four points of the OBB onto the given axis and return the dotproducts of the two outermost points
+bool OrientedBoundingBox::Refresh(const sf::Sprite& Object) // Update only if the sprite has moved, turned or been resized since the last update, returns true if it did
+{
+	if (Valid &&
+		Object.getPosition() == Position &&
+		Object.getRotation() == Rotation &&
+		Object.getScale() == Scale &&
+		Object.getOrigin() == Origin &&
+		Object.getLocalBounds().width == Size.x &&
+		Object.getLocalBounds().height == Size.y)
+	{
+		return false;
+	}
+
+	Update(Object);
+	return true;
+}
+
+void OrientedBoundingBox::ProjectOntoAxis(const sf::Vector2f& Axis, float& Min, float& Max) const // Project all four points of the OBB onto the given axis and return the dotproducts of the two outermost points
 {
 	Min = (Points[0].x*Axis.x + Points[0].y*Axis.y);
 	Max = Min;
@@ -28,4 +72,36 @@ void OrientedBoundingBox::ProjectOntoAxis(const sf::Vector2f& Axis, float& Min,
 		if (Projection>Max)
 			Max = Projection;
 	}
-}
\ No newline at end of file
+}
+
+void OrientedBoundingBoxBatch::Clear() // Remove all boxes
+{
+	for (int j = 0; j<4; j++)
+	{
+		X[j].clear();
+		Y[j].clear();
+	}
+	CentreX.clear();
+	CentreY.clear();
+	Radius.clear();
+	MinX.clear();
+	MaxX.clear();
+	MinY.clear();
+	MaxY.clear();
+}
+
+void OrientedBoundingBoxBatch::Add(const OrientedBoundingBox& Box) // Append a copy of the box's corners
+{
+	for (int j = 0; j<4; j++)
+	{
+		X[j].push_back(Box.Points[j].x);
+		Y[j].push_back(Box.Points[j].y);
+	}
+	CentreX.push_back(Box.Centre.x);
+	CentreY.push_back(Box.Centre.y);
+	Radius.push_back(Box.Radius);
+	MinX.push_back(Box.Bounds.left);
+	MaxX.push_back(Box.Bounds.left + Box.Bounds.width);
+	MinY.push_back(Box.Bounds.top);
+	MaxY.push_back(Box.Bounds.top + Box.Bounds.height);
+}
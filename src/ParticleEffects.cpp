@@ -0,0 +1,46 @@
+#include "ParticleEffects.h"
+
+namespace
+{
+	/// <summary>
+	/// @brief Emitter settings for a preset; position is filled in by each burst
+	/// </summary>
+	ParticleEmitter emitter(float t_rate, sf::Vector2f t_velocity, float t_deflection, sf::Time t_minLifetime, sf::Time t_maxLifetime)
+	{
+		ParticleEmitter settings;
+		settings.emissionRate = t_rate;
+		settings.velocity = t_velocity;
+		settings.deflection = t_deflection;
+		settings.minLifetime = t_minLifetime;
+		settings.maxLifetime = t_maxLifetime;
+
+		return settings;
+	}
+}
+
+////////////////////////////////////////////////////////////
+
+const ParticleEffect ParticleEffects::MUZZLE_SPARKS{
+	emitter(500.0f, { 250.0f,0.0f }, 10.0f, sf::seconds(0.1f), sf::seconds(2.0f)),
+	sf::seconds(0.05f), 0.0f, 1.0f, { 0.0f,0.0f }, ParticleTexture::Spark,
+	ParticleBlend::Alpha, 1500, 1 };
+
+const ParticleEffect ParticleEffects::MUZZLE_SMOKE{
+	emitter(500.0f, { 60.0f,0.0f }, 120.0f, sf::seconds(0.1f), sf::seconds(1.5f)),
+	sf::seconds(0.1f), 0.0f, 1.0f, { 1.1f,1.1f }, ParticleTexture::Smoke,
+	ParticleBlend::Alpha, 2000, 2 };
+
+const ParticleEffect ParticleEffects::IMPACT_SMOKE{
+	emitter(500.0f, { 40.0f,40.0f }, 360.0f, sf::seconds(0.1f), sf::seconds(0.75f)),
+	sf::seconds(0.25f), 0.0f, 1.0f, { 1.1f,1.1f }, ParticleTexture::Smoke,
+	ParticleBlend::Alpha, 1500, 2 };
+
+const ParticleEffect ParticleEffects::TRACK_SPARKS{
+	emitter(150.0f, { 30.0f,30.0f }, 180.0f, sf::seconds(0.1f), sf::seconds(1.5f)),
+	sf::Time::Zero, 0.0f, 1.0f, { 0.0f,0.0f }, ParticleTexture::Spark,
+	ParticleBlend::Alpha, 500, 0 };
+
+const ParticleEffect ParticleEffects::ENGINE_SMOKE{
+	emitter(0.0f, { 30.0f,30.0f }, 360.0f, sf::seconds(0.1f), sf::seconds(1.5f)),
+	sf::Time::Zero, 0.0f, 1.0f, { 1.1f,1.25f }, ParticleTexture::Smoke,
+	ParticleBlend::Alpha, 1000, 0 };
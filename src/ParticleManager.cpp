@@ -0,0 +1,239 @@
+#include "ParticleManager.h"
+#include "ParticleEffects.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace
+{
+	/// <summary>
+	/// @brief Every effect, in the order they're drawn
+	/// </summary>
+	std::array<ParticleEffect const*, 5> effectsInDrawOrder()
+	{
+		return {
+			&ParticleEffects::IMPACT_SMOKE,
+			&ParticleEffects::MUZZLE_SMOKE,
+			&ParticleEffects::ENGINE_SMOKE,
+			&ParticleEffects::MUZZLE_SPARKS,
+			&ParticleEffects::TRACK_SPARKS
+		};
+	}
+
+	/// <summary>
+	/// @brief World-space box round everything a view shows, allowing for its rotation
+	/// </summary>
+	sf::FloatRect visibleArea(sf::View const& t_view)
+	{
+		const float angle{ t_view.getRotation() * 3.14159265f / 180.0f };
+		const float cosine{ std::abs(std::cos(angle)) };
+		const float sine{ std::abs(std::sin(angle)) };
+		const sf::Vector2f half{ t_view.getSize() / 2.0f };
+
+		const sf::Vector2f reach{ half.x * cosine + half.y * sine, half.x * sine + half.y * cosine };
+
+		return { t_view.getCenter() - reach, reach * 2.0f };
+	}
+}
+
+////////////////////////////////////////////////////////////
+
+ParticleManager::ParticleManager()
+{
+	for (ParticleEffect const* effect : effectsInDrawOrder())
+	{
+		m_systems.emplace_back();
+		m_systems.back().setEffect(*effect);
+		m_budgetOrder.push_back(m_budgetOrder.size());
+	}
+
+	std::stable_sort(m_budgetOrder.begin(), m_budgetOrder.end(), [this](std::size_t t_a, std::size_t t_b)
+		{
+			return m_systems[t_a].getEffect()->priority < m_systems[t_b].getEffect()->priority;
+		});
+}
+
+////////////////////////////////////////////////////////////
+
+void ParticleManager::setTextures(sf::Texture const& t_smoke, sf::Texture const& t_spark)
+{
+	const sf::Image smoke{ t_smoke.copyToImage() };
+	const sf::Image spark{ t_spark.copyToImage() };
+
+	const sf::Vector2u smokeSize{ smoke.getSize() };
+	const sf::Vector2u sparkSize{ spark.getSize() };
+
+	// side by side, smoke on the left
+	sf::Image atlas;
+	atlas.create(smokeSize.x + ATLAS_PADDING + sparkSize.x, std::max(smokeSize.y, sparkSize.y), sf::Color::Transparent);
+	atlas.copy(smoke, 0, 0);
+	atlas.copy(spark, smokeSize.x + ATLAS_PADDING, 0);
+
+	if (!m_atlas.loadFromImage(atlas))
+	{
+		throw std::runtime_error("Error building particle atlas in ParticleManager.cpp>setTextures");
+	}
+
+	m_atlas.setSmooth(t_smoke.isSmooth());
+
+	const sf::FloatRect smokeRect{ 0.0f, 0.0f, static_cast<float>(smokeSize.x), static_cast<float>(smokeSize.y) };
+	const sf::FloatRect sparkRect{ static_cast<float>(smokeSize.x + ATLAS_PADDING), 0.0f, static_cast<float>(sparkSize.x), static_cast<float>(sparkSize.y) };
+
+	for (ParticleSystem& system : m_systems)
+	{
+		system.setTextureRect((system.getEffect()->texture == ParticleTexture::Spark) ? sparkRect : smokeRect);
+	}
+
+	m_verticesStale = true;
+}
+
+////////////////////////////////////////////////////////////
+
+std::size_t ParticleManager::findSystem(ParticleEffect const& t_effect) const
+{
+	for (std::size_t i = 0; i < m_systems.size(); i++)
+	{
+		if (m_systems[i].getEffect() == &t_effect)
+		{
+			return i;
+		}
+	}
+
+	throw std::runtime_error("Particle effect isn't one of ParticleEffects in ParticleManager.cpp>findSystem");
+}
+
+////////////////////////////////////////////////////////////
+
+void ParticleManager::burst(ParticleEffect const& t_effect, sf::Vector2f t_position, sf::Vector2f t_direction)
+{
+	m_systems[findSystem(t_effect)].burst(t_position, t_direction);
+}
+
+////////////////////////////////////////////////////////////
+
+ParticleManager::EmitterHandle ParticleManager::addPersistentEmitter(ParticleEffect const& t_effect, bool t_enabled)
+{
+	std::size_t system{ findSystem(t_effect) };
+
+	return { system, m_systems[system].addPersistentEmitter(t_effect.emitter, t_enabled) };
+}
+
+////////////////////////////////////////////////////////////
+
+void ParticleManager::clear()
+{
+	for (ParticleSystem& system : m_systems)
+	{
+		system.clearEmitters();
+		system.clearParticles();
+	}
+
+	m_verticesStale = true;
+}
+
+////////////////////////////////////////////////////////////
+
+void ParticleManager::update(sf::Time t_dt)
+{
+	PROFILE_SCOPE("ParticleManager::update");
+
+	// every system sheds its dead before any emits, so all the room they free is shared out below
+	std::size_t alive{ 0 };
+
+	for (ParticleSystem& system : m_systems)
+	{
+		system.updateParticles(t_dt);
+		alive += system.getParticleCount();
+	}
+
+	// highest priority first, so freed room goes to the player's effects before anyone else's.
+	// Each system may only grow into the room left at its turn, so the total can't pass the budget
+	for (std::size_t index : m_budgetOrder)
+	{
+		ParticleSystem& system{ m_systems[index] };
+		ParticleEffect const& effect{ *system.getEffect() };
+
+		const std::size_t before{ system.getParticleCount() };
+		const std::size_t room{ (alive < PARTICLE_BUDGET) ? PARTICLE_BUDGET - alive : 0 };
+		const std::size_t growth{ (before < effect.maxParticles) ? std::min(effect.maxParticles - before, room) : 0 };
+
+		system.setParticleLimit(before + growth);
+		system.setEmissionScale((effect.priority == 0) ? 1.0f : m_emissionScale);
+		system.updateEmitters(t_dt);
+
+		alive += system.getParticleCount() - before;
+	}
+
+	m_verticesStale = true;
+}
+
+////////////////////////////////////////////////////////////
+
+void ParticleManager::adaptToFrameTime(sf::Time t_frameTime)
+{
+	m_smoothedFrameTime += (t_frameTime.asSeconds() - m_smoothedFrameTime) * FRAME_TIME_SMOOTHING;
+
+	// emit in proportion to how far over the target we are
+	m_emissionScale = (m_smoothedFrameTime > TARGET_FRAME_TIME) ? std::max(MIN_EMISSION_SCALE, TARGET_FRAME_TIME / m_smoothedFrameTime) : 1.0f;
+}
+
+////////////////////////////////////////////////////////////
+
+ParticleSystem::Stats ParticleManager::getStats() const
+{
+	ParticleSystem::Stats stats;
+
+	for (ParticleSystem const& system : m_systems)
+	{
+		system.addStats(stats);
+	}
+
+	return stats;
+}
+
+////////////////////////////////////////////////////////////
+
+void ParticleManager::draw(sf::RenderTarget& t_target, sf::RenderStates t_states) const
+{
+	const sf::FloatRect area{ visibleArea(t_target.getView()) };
+
+	if (m_verticesStale || area != m_builtArea)
+	{
+		PROFILE_SCOPE("ParticleManager::buildVertices");
+
+		m_drawn = 0;
+
+		for (std::vector<sf::Vertex>& vertices : m_vertices)
+		{
+			vertices.clear();
+		}
+
+		for (ParticleSystem const& system : m_systems)
+		{
+			system.appendVertices(m_vertices[static_cast<std::size_t>(system.getEffect()->blend)], area);
+		}
+
+		for (std::vector<sf::Vertex> const& vertices : m_vertices)
+		{
+			m_drawn += vertices.size() / 4;
+		}
+
+		m_builtArea = area;
+		m_verticesStale = false;
+	}
+
+	const sf::BlendMode blendModes[BLEND_MODES]{ sf::BlendAlpha, sf::BlendAdd };
+
+	t_states.texture = &m_atlas;
+	m_drawCalls = 0;
+
+	for (std::size_t mode = 0; mode < BLEND_MODES; mode++)
+	{
+		if (m_vertices[mode].empty()) continue;
+
+		t_states.blendMode = blendModes[mode];
+		t_target.draw(m_vertices[mode].data(), m_vertices[mode].size(), sf::Quads, t_states);
+		m_drawCalls++;
+	}
+}
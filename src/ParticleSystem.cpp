@@ -0,0 +1,504 @@
+#include "ParticleSystem.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <stdexcept>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PARTICLES_USE_SSE
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+	const float DEGREES_TO_RADIANS{ 3.14159265f / 180.0f };
+
+	/// <summary>
+	/// @brief Seed for the next system's random engine, so systems built in the same order emit the same particles
+	/// </summary>
+	unsigned nextSeed()
+	{
+		static std::atomic<unsigned> seed{ 1u };
+		return seed++;
+	}
+}
+
+////////////////////////////////////////////////////////////
+
+ParticleSystem::ParticleSystem()
+	: m_random(nextSeed())
+{
+}
+
+////////////////////////////////////////////////////////////
+
+void ParticleSystem::setEffect(ParticleEffect const& t_effect)
+{
+	m_effect = &t_effect;
+
+	clearAffectors();
+	addFadeAffector(t_effect.fadeIn, t_effect.fadeOut);
+
+	if (t_effect.scaleRate != sf::Vector2f{ 0.0f, 0.0f })
+	{
+		addScaleAffector(t_effect.scaleRate);
+	}
+}
+
+////////////////////////////////////////////////////////////
+
+void ParticleSystem::burst(sf::Vector2f t_position, sf::Vector2f t_direction)
+{
+	if (m_effect == nullptr)
+	{
+		throw std::runtime_error("ParticleSystem::burst called before setEffect");
+	}
+
+	ParticleEmitter emitter{ m_effect->emitter };
+	emitter.position = t_position;
+
+	// rotate +x onto the direction
+	sf::Vector2f velocity{ emitter.velocity };
+	emitter.velocity = { velocity.x * t_direction.x - velocity.y * t_direction.y, velocity.x * t_direction.y + velocity.y * t_direction.x };
+
+	addEmitter(emitter, m_effect->burstDuration);
+}
+
+////////////////////////////////////////////////////////////
+
+void ParticleSystem::addEmitter(ParticleEmitter const& t_emitter, sf::Time t_duration)
+{
+	m_emitters.push_back({ t_emitter, t_duration, t_duration != sf::Time::Zero });
+}
+
+////////////////////////////////////////////////////////////
+
+void ParticleSystem::addFadeAffector(float t_fadeIn, float t_fadeOut, sf::Time t_duration)
+{
+	m_affectors.push_back({ Affector::Type::Fade, t_fadeIn, t_fadeOut, { 0.0f, 0.0f }, t_duration, t_duration != sf::Time::Zero });
+}
+
+////////////////////////////////////////////////////////////
+
+void ParticleSystem::addScaleAffector(sf::Vector2f t_rate, sf::Time t_duration)
+{
+	m_affectors.push_back({ Affector::Type::Scale, 0.0f, 0.0f, t_rate, t_duration, t_duration != sf::Time::Zero });
+}
+
+////////////////////////////////////////////////////////////
+
+ParticleSystem::EmitterHandle ParticleSystem::addPersistentEmitter(ParticleEmitter const& t_emitter, bool t_enabled)
+{
+	m_persistentEmitters.push_back({ t_emitter, sf::Time::Zero, false, 0.0f, t_enabled });
+
+	return m_persistentEmitters.size() - 1;
+}
+
+////////////////////////////////////////////////////////////
+
+void ParticleSystem::setEmitterEnabled(EmitterHandle t_handle, bool t_enabled)
+{
+	ActiveEmitter& emitter{ m_persistentEmitters[t_handle] };
+
+	// don't carry a part-particle over a gap in emission
+	if (!t_enabled)
+	{
+		emitter.pending = 0.0f;
+	}
+
+	emitter.enabled = t_enabled;
+}
+
+////////////////////////////////////////////////////////////
+
+void ParticleSystem::clearEmitters()
+{
+	m_emitters.clear();
+
+	for (EmitterHandle handle = 0; handle < m_persistentEmitters.size(); handle++)
+	{
+		setEmitterEnabled(handle, false);
+	}
+}
+
+////////////////////////////////////////////////////////////
+
+std::size_t ParticleSystem::getEmitterCount() const
+{
+	std::size_t count{ m_emitters.size() };
+
+	for (ActiveEmitter const& emitter : m_persistentEmitters)
+	{
+		if (emitter.enabled) count++;
+	}
+
+	return count;
+}
+
+////////////////////////////////////////////////////////////
+
+void ParticleSystem::clearAffectors()
+{
+	m_affectors.clear();
+}
+
+////////////////////////////////////////////////////////////
+
+void ParticleSystem::clearParticles()
+{
+	m_positionX.clear();
+	m_positionY.clear();
+	m_velocityX.clear();
+	m_velocityY.clear();
+	m_rotation.clear();
+	m_rotationSpeed.clear();
+	m_scaleX.clear();
+	m_scaleY.clear();
+	m_elapsed.clear();
+	m_lifetime.clear();
+	m_alpha.clear();
+	m_colour.clear();
+
+	m_dropped = 0;
+}
+
+////////////////////////////////////////////////////////////
+
+void ParticleSystem::addStats(Stats& t_stats) const
+{
+	t_stats.systems++;
+	t_stats.particles += m_positionX.size();
+	t_stats.emitters += getEmitterCount();
+	t_stats.affectors += m_affectors.size();
+	t_stats.mostAffectors = std::max(t_stats.mostAffectors, m_affectors.size());
+	t_stats.dropped += m_dropped;
+}
+
+////////////////////////////////////////////////////////////
+
+void ParticleSystem::update(sf::Time t_dt)
+{
+	updateParticles(t_dt);
+	updateEmitters(t_dt);
+}
+
+////////////////////////////////////////////////////////////
+
+void ParticleSystem::updateParticles(sf::Time t_dt)
+{
+	PROFILE_SCOPE("ParticleSystem::updateParticles");
+
+	const float dt{ t_dt.asSeconds() };
+
+	integrate(dt);
+	removeDead();
+
+	for (Affector const& affector : m_affectors)
+	{
+		if (affector.type == Affector::Type::Fade)
+		{
+			fade(affector.fadeIn, affector.fadeOut);
+		}
+		else
+		{
+			scale(affector.rate, dt);
+		}
+	}
+
+	for (Affector& affector : m_affectors)
+	{
+		affector.remaining -= t_dt;
+	}
+
+	m_affectors.erase(std::remove_if(m_affectors.begin(), m_affectors.end(),
+		[](Affector const& affector) { return affector.timed && affector.remaining <= sf::Time::Zero; }), m_affectors.end());
+}
+
+////////////////////////////////////////////////////////////
+
+void ParticleSystem::updateEmitters(sf::Time t_dt)
+{
+	PROFILE_SCOPE("ParticleSystem::updateEmitters");
+
+	const float dt{ t_dt.asSeconds() };
+
+	for (ActiveEmitter& emitter : m_persistentEmitters)
+	{
+		if (emitter.enabled)
+		{
+			runEmitter(emitter, dt);
+		}
+	}
+
+	for (ActiveEmitter& emitter : m_emitters)
+	{
+		runEmitter(emitter, dt);
+		emitter.remaining -= t_dt;
+	}
+
+	m_emitters.erase(std::remove_if(m_emitters.begin(), m_emitters.end(),
+		[](ActiveEmitter const& emitter) { return emitter.timed && emitter.remaining <= sf::Time::Zero; }), m_emitters.end());
+}
+
+////////////////////////////////////////////////////////////
+
+void ParticleSystem::runEmitter(ActiveEmitter& t_emitter, float t_dt)
+{
+	t_emitter.pending += t_emitter.settings.emissionRate * m_emissionScale * t_dt;
+
+	for (; t_emitter.pending >= 1.0f; t_emitter.pending -= 1.0f)
+	{
+		emit(t_emitter.settings);
+	}
+}
+
+////////////////////////////////////////////////////////////
+
+void ParticleSystem::emit(ParticleEmitter const& t_emitter)
+{
+	if (m_positionX.size() >= m_particleLimit)
+	{
+		m_dropped++;
+		return;
+	}
+
+	std::uniform_real_distribution<float> deflection(-t_emitter.deflection, t_emitter.deflection);
+	std::uniform_real_distribution<float> lifetime(t_emitter.minLifetime.asSeconds(), t_emitter.maxLifetime.asSeconds());
+
+	const float angle{ deflection(m_random) * DEGREES_TO_RADIANS };
+	const float cosine{ std::cos(angle) };
+	const float sine{ std::sin(angle) };
+
+	m_positionX.push_back(t_emitter.position.x);
+	m_positionY.push_back(t_emitter.position.y);
+	m_velocityX.push_back(t_emitter.velocity.x * cosine - t_emitter.velocity.y * sine);
+	m_velocityY.push_back(t_emitter.velocity.x * sine + t_emitter.velocity.y * cosine);
+	m_rotation.push_back(t_emitter.rotation);
+	m_rotationSpeed.push_back(t_emitter.rotationSpeed);
+	m_scaleX.push_back(t_emitter.scale.x);
+	m_scaleY.push_back(t_emitter.scale.y);
+	m_elapsed.push_back(0.0f);
+	// never zero, the fade divides by it
+	m_lifetime.push_back(std::max(lifetime(m_random), 0.001f));
+	m_alpha.push_back(1.0f);
+	m_colour.push_back(t_emitter.colour);
+}
+
+////////////////////////////////////////////////////////////
+
+void ParticleSystem::integrate(float t_dt)
+{
+	const std::size_t count{ m_positionX.size() };
+	std::size_t i{ 0 };
+
+#ifdef PARTICLES_USE_SSE
+	const __m128 dt = _mm_set1_ps(t_dt);
+
+	for (; i + 4 <= count; i += 4)
+	{
+		_mm_storeu_ps(&m_positionX[i], _mm_add_ps(_mm_loadu_ps(&m_positionX[i]), _mm_mul_ps(_mm_loadu_ps(&m_velocityX[i]), dt)));
+		_mm_storeu_ps(&m_positionY[i], _mm_add_ps(_mm_loadu_ps(&m_positionY[i]), _mm_mul_ps(_mm_loadu_ps(&m_velocityY[i]), dt)));
+		_mm_storeu_ps(&m_rotation[i], _mm_add_ps(_mm_loadu_ps(&m_rotation[i]), _mm_mul_ps(_mm_loadu_ps(&m_rotationSpeed[i]), dt)));
+		_mm_storeu_ps(&m_elapsed[i], _mm_add_ps(_mm_loadu_ps(&m_elapsed[i]), dt));
+	}
+#endif
+
+	for (; i < count; i++)
+	{
+		m_positionX[i] += m_velocityX[i] * t_dt;
+		m_positionY[i] += m_velocityY[i] * t_dt;
+		m_rotation[i] += m_rotationSpeed[i] * t_dt;
+		m_elapsed[i] += t_dt;
+	}
+}
+
+////////////////////////////////////////////////////////////
+
+void ParticleSystem::removeDead()
+{
+	std::size_t count{ m_positionX.size() };
+	std::size_t i{ 0 };
+
+	while (i < count)
+	{
+#ifdef PARTICLES_USE_SSE
+		// most particles are alive, so step over four at a time until a lane has expired
+		if (i + 4 <= count && _mm_movemask_ps(_mm_cmpge_ps(_mm_loadu_ps(&m_elapsed[i]), _mm_loadu_ps(&m_lifetime[i]))) == 0)
+		{
+			i += 4;
+			continue;
+		}
+#endif
+
+		if (m_elapsed[i] < m_lifetime[i])
+		{
+			i++;
+			continue;
+		}
+
+		// the last particle takes this one's place, and is checked next
+		count--;
+
+		m_positionX[i] = m_positionX[count];
+		m_positionY[i] = m_positionY[count];
+		m_velocityX[i] = m_velocityX[count];
+		m_velocityY[i] = m_velocityY[count];
+		m_rotation[i] = m_rotation[count];
+		m_rotationSpeed[i] = m_rotationSpeed[count];
+		m_scaleX[i] = m_scaleX[count];
+		m_scaleY[i] = m_scaleY[count];
+		m_elapsed[i] = m_elapsed[count];
+		m_lifetime[i] = m_lifetime[count];
+		m_alpha[i] = m_alpha[count];
+		m_colour[i] = m_colour[count];
+	}
+
+	// pop every dead particle at once
+	m_positionX.resize(count);
+	m_positionY.resize(count);
+	m_velocityX.resize(count);
+	m_velocityY.resize(count);
+	m_rotation.resize(count);
+	m_rotationSpeed.resize(count);
+	m_scaleX.resize(count);
+	m_scaleY.resize(count);
+	m_elapsed.resize(count);
+	m_lifetime.resize(count);
+	m_alpha.resize(count);
+	m_colour.resize(count);
+}
+
+////////////////////////////////////////////////////////////
+
+void ParticleSystem::fade(float t_fadeIn, float t_fadeOut)
+{
+	// alpha = min(1, progress / fadeIn, (1 - progress) / fadeOut), which is 1 in the middle of a particle's life
+	// and ramps at either end. A ratio of zero means no ramp; multiplying by zero and adding one keeps that
+	// branch-free without dividing by zero
+	const float inSlope{ (t_fadeIn > 0.0f) ? 1.0f / t_fadeIn : 0.0f };
+	const float inBias{ (t_fadeIn > 0.0f) ? 0.0f : 1.0f };
+	const float outSlope{ (t_fadeOut > 0.0f) ? 1.0f / t_fadeOut : 0.0f };
+	const float outBias{ (t_fadeOut > 0.0f) ? 0.0f : 1.0f };
+
+	const std::size_t count{ m_positionX.size() };
+	std::size_t i{ 0 };
+
+#ifdef PARTICLES_USE_SSE
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 inSlopes = _mm_set1_ps(inSlope);
+	const __m128 inBiases = _mm_set1_ps(inBias);
+	const __m128 outSlopes = _mm_set1_ps(outSlope);
+	const __m128 outBiases = _mm_set1_ps(outBias);
+
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 progress = _mm_div_ps(_mm_loadu_ps(&m_elapsed[i]), _mm_loadu_ps(&m_lifetime[i]));
+		__m128 fadingIn = _mm_add_ps(_mm_mul_ps(progress, inSlopes), inBiases);
+		__m128 fadingOut = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(one, progress), outSlopes), outBiases);
+
+		_mm_storeu_ps(&m_alpha[i], _mm_max_ps(zero, _mm_min_ps(one, _mm_min_ps(fadingIn, fadingOut))));
+	}
+#endif
+
+	for (; i < count; i++)
+	{
+		float progress{ m_elapsed[i] / m_lifetime[i] };
+		float fadingIn{ progress * inSlope + inBias };
+		float fadingOut{ (1.0f - progress) * outSlope + outBias };
+
+		m_alpha[i] = std::max(0.0f, std::min(1.0f, std::min(fadingIn, fadingOut)));
+	}
+}
+
+////////////////////////////////////////////////////////////
+
+void ParticleSystem::scale(sf::Vector2f t_rate, float t_dt)
+{
+	const float growX{ t_rate.x * t_dt };
+	const float growY{ t_rate.y * t_dt };
+
+	const std::size_t count{ m_positionX.size() };
+	std::size_t i{ 0 };
+
+#ifdef PARTICLES_USE_SSE
+	const __m128 growXs = _mm_set1_ps(growX);
+	const __m128 growYs = _mm_set1_ps(growY);
+
+	for (; i + 4 <= count; i += 4)
+	{
+		_mm_storeu_ps(&m_scaleX[i], _mm_add_ps(_mm_loadu_ps(&m_scaleX[i]), growXs));
+		_mm_storeu_ps(&m_scaleY[i], _mm_add_ps(_mm_loadu_ps(&m_scaleY[i]), growYs));
+	}
+#endif
+
+	for (; i < count; i++)
+	{
+		m_scaleX[i] += growX;
+		m_scaleY[i] += growY;
+	}
+}
+
+////////////////////////////////////////////////////////////
+
+void ParticleSystem::appendVertices(std::vector<sf::Vertex>& t_vertices, sf::FloatRect t_visibleArea) const
+{
+	const std::size_t count{ m_positionX.size() };
+	const std::size_t first{ t_vertices.size() };
+	t_vertices.resize(first + count * 4);
+
+	const sf::Vector2f halfSize{ m_textureRect.width / 2.0f, m_textureRect.height / 2.0f };
+	const float left{ m_textureRect.left };
+	const float top{ m_textureRect.top };
+	const float right{ m_textureRect.left + m_textureRect.width };
+	const float bottom{ m_textureRect.top + m_textureRect.height };
+
+	const float visibleRight{ t_visibleArea.left + t_visibleArea.width };
+	const float visibleBottom{ t_visibleArea.top + t_visibleArea.height };
+
+	std::size_t written{ 0 };
+
+	for (std::size_t i = 0; i < count; i++)
+	{
+		const float halfWidth{ halfSize.x * m_scaleX[i] };
+		const float halfHeight{ halfSize.y * m_scaleY[i] };
+
+		// corner offsets from the centre, clockwise from the top left
+		sf::Vector2f across{ halfWidth, 0.0f };
+		sf::Vector2f down{ 0.0f, halfHeight };
+
+		if (m_rotation[i] != 0.0f)
+		{
+			const float angle{ m_rotation[i] * DEGREES_TO_RADIANS };
+			const float cosine{ std::cos(angle) };
+			const float sine{ std::sin(angle) };
+
+			across = { halfWidth * cosine, halfWidth * sine };
+			down = { -halfHeight * sine, halfHeight * cosine };
+		}
+
+		const sf::Vector2f centre{ m_positionX[i], m_positionY[i] };
+
+		// half the quad's bounding box, however it's turned
+		const float reachX{ std::abs(across.x) + std::abs(down.x) };
+		const float reachY{ std::abs(across.y) + std::abs(down.y) };
+
+		if (centre.x + reachX < t_visibleArea.left || centre.x - reachX > visibleRight ||
+			centre.y + reachY < t_visibleArea.top || centre.y - reachY > visibleBottom) continue;
+
+		sf::Color colour{ m_colour[i] };
+		colour.a = static_cast<sf::Uint8>(colour.a * m_alpha[i]);
+
+		sf::Vertex* quad{ &t_vertices[first + written * 4] };
+
+		quad[0] = sf::Vertex(centre - across - down, colour, { left, top });
+		quad[1] = sf::Vertex(centre + across - down, colour, { right, top });
+		quad[2] = sf::Vertex(centre + across + down, colour, { right, bottom });
+		quad[3] = sf::Vertex(centre - across + down, colour, { left, bottom });
+
+		written++;
+	}
+
+	t_vertices.resize(first + written * 4);
+}
@@ -0,0 +1,116 @@
+#include "PerceptionScheduler.h"
+#include <algorithm>
+
+void PerceptionScheduler::reset(std::size_t t_count)
+{
+	m_waiting.resize(t_count);
+
+	// start everyone on a different phase, so tanks sharing an interval don't all look on the same tick
+	for (std::size_t i = 0; i < t_count; i++)
+	{
+		m_waiting[i] = static_cast<unsigned>(i % FAR_INTERVAL);
+	}
+
+	m_deferred = 0;
+}
+
+////////////////////////////////////////////////////////////
+
+unsigned PerceptionScheduler::intervalFor(Need const& t_need)
+{
+	if (t_need.engaged)
+	{
+		return 1;
+	}
+
+	if (t_need.onScreen && t_need.distanceToPlayer < NEAR_RANGE)
+	{
+		return NEAR_INTERVAL;
+	}
+
+	if (t_need.onScreen || t_need.distanceToPlayer < FAR_RANGE)
+	{
+		return MID_INTERVAL;
+	}
+
+	return FAR_INTERVAL;
+}
+
+////////////////////////////////////////////////////////////
+
+void PerceptionScheduler::schedule(std::vector<Need> const& t_needs, std::vector<char>& t_perceive)
+{
+	if (m_waiting.size() != t_needs.size())
+	{
+		reset(t_needs.size());
+	}
+
+	t_perceive.assign(t_needs.size(), 0);
+	m_candidates.clear();
+
+	unsigned mandatory{ 0 };
+
+	for (std::size_t i = 0; i < t_needs.size(); i++)
+	{
+		m_waiting[i]++;
+
+		unsigned interval{ intervalFor(t_needs[i]) };
+
+		if (t_needs[i].engaged || m_waiting[i] >= interval * MAX_INTERVALS_LATE)
+		{
+			t_perceive[i] = 1;
+			mandatory++;
+		}
+		else if (m_waiting[i] >= interval)
+		{
+			m_candidates.push_back({ m_waiting[i] - interval, i });
+		}
+	}
+
+	std::size_t allowed{ m_candidates.size() };
+
+	if (m_budget > sf::Time::Zero && m_averageCost > 0.0f)
+	{
+		float spare{ static_cast<float>(m_budget.asMicroseconds()) - mandatory * m_averageCost };
+
+		allowed = (spare > 0.0f) ? std::min(allowed, static_cast<std::size_t>(spare / m_averageCost)) : 0;
+	}
+
+	// most overdue first, ties in roster order so the choice never depends on sort internals
+	if (allowed < m_candidates.size())
+	{
+		std::sort(m_candidates.begin(), m_candidates.end(), [](auto const& a, auto const& b)
+		{
+			return (a.first != b.first) ? a.first > b.first : a.second < b.second;
+		});
+	}
+
+	for (std::size_t i = 0; i < allowed; i++)
+	{
+		t_perceive[m_candidates[i].second] = 1;
+	}
+
+	m_deferred = static_cast<unsigned>(m_candidates.size() - allowed);
+
+	for (std::size_t i = 0; i < t_perceive.size(); i++)
+	{
+		if (t_perceive[i])
+		{
+			m_waiting[i] = 0;
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////
+
+void PerceptionScheduler::reportCost(sf::Time t_total, unsigned t_count)
+{
+	if (0 == t_count)
+	{
+		return;
+	}
+
+	float sample{ static_cast<float>(t_total.asMicroseconds()) / t_count };
+
+	m_averageCost = (m_averageCost > 0.0f) ? m_averageCost + (sample - m_averageCost) * COST_SMOOTHING : sample;
+}
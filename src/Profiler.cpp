@@ -0,0 +1,221 @@
+#include "Profiler.h"
+#include <algorithm>
+#include <fstream>
+
+namespace
+{
+	// how many scopes are open on this thread
+	thread_local int scopeDepth{ 0 };
+
+	double toMs(std::int64_t t_ns)
+	{
+		return t_ns / 1000000.0;
+	}
+}
+
+////////////////////////////////////////////////////////////
+
+Profiler::Scope::Scope(int t_section) :
+	m_section(t_section),
+	m_depth(scopeDepth++),
+	m_start(std::chrono::steady_clock::now())
+{
+}
+
+////////////////////////////////////////////////////////////
+
+Profiler::Scope::~Scope()
+{
+	Profiler::get().record(m_section, m_depth, m_start, std::chrono::steady_clock::now() - m_start);
+	scopeDepth--;
+}
+
+////////////////////////////////////////////////////////////
+
+Profiler::Profiler() :
+	m_slots(std::make_unique<Slot[]>(CAPACITY)),
+	m_epoch(std::chrono::steady_clock::now())
+{
+}
+
+////////////////////////////////////////////////////////////
+
+Profiler& Profiler::get()
+{
+	static Profiler profiler;
+	return profiler;
+}
+
+////////////////////////////////////////////////////////////
+
+int Profiler::registerSection(const char* t_name)
+{
+	std::lock_guard<std::mutex> lock(m_sectionMutex);
+
+	auto it = std::find(m_sectionNames.begin(), m_sectionNames.end(), t_name);
+
+	if (it != m_sectionNames.end())
+	{
+		return static_cast<int>(it - m_sectionNames.begin());
+	}
+
+	m_sectionNames.push_back(t_name);
+
+	return static_cast<int>(m_sectionNames.size() - 1);
+}
+
+////////////////////////////////////////////////////////////
+
+void Profiler::record(int t_section, int t_depth, std::chrono::steady_clock::time_point t_start, std::chrono::steady_clock::duration t_duration)
+{
+	std::uint64_t index{ m_nextWrite.fetch_add(1, std::memory_order_relaxed) };
+	Slot& slot{ m_slots[index & (CAPACITY - 1)] };
+
+	// mark the slot as being written, fill it in, then publish it under its new sequence number
+	slot.sequence.store(0, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	slot.section.store(t_section, std::memory_order_relaxed);
+	slot.depth.store(t_depth, std::memory_order_relaxed);
+	slot.startNs.store(std::chrono::duration_cast<std::chrono::nanoseconds>(t_start - m_epoch).count(), std::memory_order_relaxed);
+	slot.durationNs.store(std::chrono::duration_cast<std::chrono::nanoseconds>(t_duration).count(), std::memory_order_relaxed);
+
+	slot.sequence.store(index + 1, std::memory_order_release);
+}
+
+////////////////////////////////////////////////////////////
+
+std::vector<Profiler::Sample> Profiler::snapshot() const
+{
+	std::vector<Sample> samples;
+	samples.reserve(CAPACITY);
+
+	for (std::size_t i = 0; i < CAPACITY; i++)
+	{
+		Slot const& slot{ m_slots[i] };
+
+		std::uint64_t before{ slot.sequence.load(std::memory_order_acquire) };
+
+		// never written, or mid-write
+		if (0 == before) continue;
+
+		Sample sample{
+			slot.section.load(std::memory_order_relaxed),
+			slot.depth.load(std::memory_order_relaxed),
+			slot.startNs.load(std::memory_order_relaxed),
+			slot.durationNs.load(std::memory_order_relaxed) };
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+
+		// overwritten while we were reading it
+		if (slot.sequence.load(std::memory_order_relaxed) != before) continue;
+
+		samples.push_back(sample);
+	}
+
+	return samples;
+}
+
+////////////////////////////////////////////////////////////
+
+std::vector<Profiler::Summary> Profiler::summarise() const
+{
+	std::vector<Sample> samples{ snapshot() };
+
+	std::vector<std::string> names;
+	{
+		std::lock_guard<std::mutex> lock(m_sectionMutex);
+		names = m_sectionNames;
+	}
+
+	std::vector<std::vector<std::int64_t>> durations(names.size());
+	std::vector<int> depths(names.size(), 0);
+
+	for (Sample const& sample : samples)
+	{
+		if (sample.section < 0 || sample.section >= static_cast<int>(names.size())) continue;
+
+		durations[sample.section].push_back(sample.durationNs);
+		depths[sample.section] = sample.depth;
+	}
+
+	std::vector<Summary> summaries;
+
+	for (std::size_t section = 0; section < names.size(); section++)
+	{
+		std::vector<std::int64_t>& times{ durations[section] };
+
+		if (times.empty()) continue;
+
+		Summary summary;
+		summary.name = names[section];
+		summary.depth = depths[section];
+		summary.count = times.size();
+
+		std::int64_t total{ 0 };
+
+		for (std::int64_t time : times)
+		{
+			total += time;
+		}
+
+		summary.meanMs = toMs(total) / times.size();
+
+		auto p99 = times.begin() + (times.size() * 99) / 100;
+		std::nth_element(times.begin(), p99, times.end());
+		summary.p99Ms = toMs(*p99);
+		summary.maxMs = toMs(*std::max_element(p99, times.end()));
+
+		summaries.push_back(summary);
+	}
+
+	return summaries;
+}
+
+////////////////////////////////////////////////////////////
+
+void Profiler::writeCsv(std::string const& t_path) const
+{
+	std::vector<Sample> samples{ snapshot() };
+
+	std::sort(samples.begin(), samples.end(), [](Sample const& t_a, Sample const& t_b) { return t_a.startNs < t_b.startNs; });
+
+	std::vector<std::string> names;
+	{
+		std::lock_guard<std::mutex> lock(m_sectionMutex);
+		names = m_sectionNames;
+	}
+
+	std::ofstream file(t_path);
+
+	file << "section,depth,start_us,duration_us\n";
+
+	for (Sample const& sample : samples)
+	{
+		file << names[sample.section] << ',' << sample.depth << ','
+			<< sample.startNs / 1000.0 << ',' << sample.durationNs / 1000.0 << '\n';
+	}
+}
+
+////////////////////////////////////////////////////////////
+
+void Profiler::writeJson(std::string const& t_path) const
+{
+	std::ofstream file(t_path);
+
+	file << "[\n";
+
+	std::vector<Summary> summaries{ summarise() };
+
+	for (std::size_t i = 0; i < summaries.size(); i++)
+	{
+		Summary const& summary{ summaries[i] };
+
+		file << "  { \"section\": \"" << summary.name << "\", \"depth\": " << summary.depth
+			<< ", \"count\": " << summary.count << ", \"mean_ms\": " << summary.meanMs
+			<< ", \"p99_ms\": " << summary.p99Ms << ", \"max_ms\": " << summary.maxMs << " }"
+			<< ((i + 1 < summaries.size()) ? ",\n" : "\n");
+	}
+
+	file << "]\n";
+}
@@ -1,19 +1,21 @@
 #include "Projectile.h"
 #include <iostream>
 
-void Projectile::init(sf::Vector2f t_pos, sf::Vector2f t_vel, int t_timeToLive)
+void Projectile::init(sf::Vector2f t_pos, sf::Vector2f t_vel, sf::Time t_timeToLive)
 {
 	m_active = true;
 	m_position = t_pos;
+	m_previousPosition = t_pos;
 	m_velocity = t_vel * m_speed;
 	m_timeToLive = t_timeToLive;
 }
 
 bool Projectile::update(sf::Time dt)
 {
+	m_previousPosition = m_position;
 	m_position += (m_velocity * dt.asSeconds());
 
-	m_timeToLive--;
+	m_timeToLive -= dt;
 
-	return (m_timeToLive > 0) ? true : false;
+	return (m_timeToLive > sf::Time::Zero) ? true : false;
 }
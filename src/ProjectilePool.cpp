@@ -1,7 +1,10 @@
 #include "ProjectilePool.h"
+#include "Profiler.h"
 #include "MathUtility.h"
 #include <iostream>
 #include <cassert>
+#include <algorithm>
+#include <cmath>
 
 ProjectilePool::ProjectilePool()
 {
@@ -29,6 +32,13 @@ void ProjectilePool::setTexture(sf::Texture const& texture)
 
 ///////////////////////////////////////////////////////////////////////////////////////////////
 
+void ProjectilePool::setSpatialGrid(SpatialGrid& t_spatialGrid)
+{
+	m_spatialGrid = &t_spatialGrid;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////
+
 void ProjectilePool::reset()
 {
 	for (Projectile& p : m_projectiles)
@@ -42,7 +52,7 @@ void ProjectilePool::reset()
 
 ///////////////////////////////////////////////////////////////////////////////////////////////
 
-void ProjectilePool::create(sf::Vector2f t_pos, sf::Vector2f t_vel, int t_timeToLive)
+void ProjectilePool::create(sf::Vector2f t_pos, sf::Vector2f t_vel, sf::Time t_timeToLive)
 {
 	// ensure there is a projectile available
 	assert(m_firstAvailable != nullptr); 
@@ -56,8 +66,6 @@ void ProjectilePool::create(sf::Vector2f t_pos, sf::Vector2f t_vel, int t_timeTo
 
 	// set rotation of our new projectile
 	newProjectile->m_baseRotation = (atan2(t_vel.y, t_vel.x)) * MathUtility::RAD_TO_DEG;
-
-	std::cout << "FIRING" << std::endl;
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////
@@ -99,63 +107,75 @@ f_generateParticle(Fooinstance, );
 
 ///////////////////////////////////////////////////////////////////////////////////////////////
 
-std::vector<sf::Vector2f> ProjectilePool::getActiveProjectilePos()
+void ProjectilePool::checkCollisions(unsigned t_layers, std::vector<ProjectileHit>& t_hits)
 {
-	std::vector<sf::Vector2f> positions;
+	PROFILE_SCOPE("ProjectilePool::checkCollisions");
+
+	if (!m_spatialGrid) return;
 
 	for (Projectile& p : m_projectiles)
 	{
-		if (p.m_active) positions.push_back(p.m_position);
-	}
+		if (p.m_active)
+		{
+			// only objects whose bounds overlap this tick's movement can be hit
+			sf::Vector2f topLeft{ std::min(p.m_previousPosition.x, p.m_position.x), std::min(p.m_previousPosition.y, p.m_position.y) };
+			sf::Vector2f size{ std::abs(p.m_position.x - p.m_previousPosition.x), std::abs(p.m_position.y - p.m_previousPosition.y) };
 
-	return positions;
+			m_spatialGrid->queryAABB({ topLeft, size }, t_layers, m_candidates);
+
+			// sweep the projectile from last tick's position to this one, so fast shells can't tunnel
+			float hitTime{ 0.0f };
+			int hit{ CollisionDetector::segmentCollision(p.m_previousPosition, p.m_position, m_candidates, hitTime) };
+
+			if (hit != -1)
+			{
+				kill(p);
+
+				// the owner tells the object it's been hit, once it's safe to touch shared state
+				t_hits.push_back({ p.m_previousPosition + (p.m_position - p.m_previousPosition) * hitTime, m_candidates[hit] });
+			}
+		} // end if p.active
+	} // end for m_projectiles
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////
 
-void ProjectilePool::checkCollisions(std::vector<GameObject*>& t_gameObjVector, std::function<void(TankAi*, sf::Vector2f)> t_smokeFunc, TankAi* t_tank)
+void ProjectilePool::syncGrid()
 {
+	if (!m_spatialGrid) return;
+
+	for (int proxy : m_deadProxies)
+	{
+		m_spatialGrid->remove(proxy);
+	}
+
+	m_deadProxies.clear();
+
 	for (Projectile& p : m_projectiles)
 	{
 		if (p.m_active)
 		{
-			for (auto& obj : t_gameObjVector)
+			if (-1 == p.m_gridProxy)
 			{
-				// assign a temp sprite to this location for collisions
-				sf::Sprite* tempSprite = new sf::Sprite();
-				tempSprite->setPosition(p.m_position);
-				tempSprite->setRotation(p.m_baseRotation);
-
-				// if they collide
-				if (CollisionDetector::collision(*tempSprite, obj->getSprite()))
-				{
-					std::cout << "IMPACT" << std::endl;
-					kill(p);
-
-					// pass position to our smoke effect function
-					t_smokeFunc(t_tank, p.m_position);
-
-					// tell our object it's been hit
-					obj->hit();
-				}
-
-				delete tempSprite;
-				tempSprite = nullptr;
-
-			} // end for t_spriteVector
-		} // end if p.active
-	} // end for m_projectiles
+				p.m_gridProxy = m_spatialGrid->insert(&p, p.m_position);
+			}
+			else
+			{
+				m_spatialGrid->update(p.m_gridProxy, p.m_position);
+			}
+		}
+	}
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////
 
-void ProjectilePool::render(sf::RenderWindow& t_window)
+void ProjectilePool::render(sf::RenderWindow& t_window, float t_alpha)
 {
 	for (Projectile& i : m_projectiles)
 	{
 		if (i.m_active)
 		{
-			m_sprite.setPosition(i.m_position);
+			m_sprite.setPosition(MathUtility::lerp(i.m_previousPosition, i.m_position, t_alpha));
 			m_sprite.setRotation(i.m_baseRotation);
 			t_window.draw(m_sprite);
 		}
@@ -173,5 +193,10 @@ void ProjectilePool::kill(Projectile& t_projectile)
 	// set inactive
 	t_projectile.m_active = false;
 
-	std::cout << "deleting bullet" << std::endl;
+	// the grid is only written in syncGrid()
+	if (-1 != t_projectile.m_gridProxy)
+	{
+		m_deadProxies.push_back(t_projectile.m_gridProxy);
+		t_projectile.m_gridProxy = -1;
+	}
 }
\ No newline at end of file
@@ -0,0 +1,46 @@
+#include "SimStopWatch.h"
+
+SimStopWatch::SimStopWatch(bool t_running) :
+	m_running(t_running)
+{
+}
+
+////////////////////////////////////////////////////////////
+
+void SimStopWatch::update(sf::Time t_dt)
+{
+	if (m_running)
+	{
+		m_elapsed += t_dt;
+	}
+}
+
+////////////////////////////////////////////////////////////
+
+void SimStopWatch::start()
+{
+	m_running = true;
+}
+
+////////////////////////////////////////////////////////////
+
+void SimStopWatch::stop()
+{
+	m_running = false;
+}
+
+////////////////////////////////////////////////////////////
+
+void SimStopWatch::reset()
+{
+	m_elapsed = sf::Time::Zero;
+	m_running = false;
+}
+
+////////////////////////////////////////////////////////////
+
+void SimStopWatch::restart()
+{
+	m_elapsed = sf::Time::Zero;
+	m_running = true;
+}
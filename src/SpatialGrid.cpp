@@ -0,0 +1,410 @@
+#include "SpatialGrid.h"
+#include <Thor/Math/Trigonometry.hpp>
+#include <algorithm>
+#include <utility>
+
+SpatialGrid::SpatialGrid() :
+	m_cellStart(CellResolution::getCellCount() + 1, 0),
+	m_dynamicCells(CellResolution::getCellCount())
+{
+}
+
+////////////////////////////////////////////////////////////
+
+SpatialGrid::ObjectSpan SpatialGrid::getCell(int t_gridRef) const
+{
+	ObjectSpan span;
+
+	if (t_gridRef < 0 || t_gridRef >= CellResolution::getCellCount() || m_cellObjects.empty())
+	{
+		return span;
+	}
+
+	span.first = m_cellObjects.data() + m_cellStart[t_gridRef];
+	span.last = m_cellObjects.data() + m_cellStart[t_gridRef + 1];
+
+	return span;
+}
+
+////////////////////////////////////////////////////////////
+
+SpatialGrid::CircleCollider const* SpatialGrid::getCellColliders(int t_gridRef) const
+{
+	if (t_gridRef < 0 || t_gridRef >= CellResolution::getCellCount() || m_cellColliders.empty())
+	{
+		return nullptr;
+	}
+
+	return m_cellColliders.data() + m_cellStart[t_gridRef];
+}
+
+////////////////////////////////////////////////////////////
+
+void SpatialGrid::clear()
+{
+	std::fill(m_cellStart.begin(), m_cellStart.end(), 0);
+	m_cellObjects.clear();
+	m_cellBounds.clear();
+	m_cellColliders.clear();
+}
+
+////////////////////////////////////////////////////////////
+
+void SpatialGrid::getCellRange(sf::FloatRect const& t_bounds, sf::Vector2i& t_min, sf::Vector2i& t_max)
+{
+	t_min = CellResolution::getCellCoords({ t_bounds.left, t_bounds.top });
+	t_max = CellResolution::getCellCoords({ t_bounds.left + t_bounds.width, t_bounds.top + t_bounds.height });
+}
+
+////////////////////////////////////////////////////////////
+
+void SpatialGrid::build(std::vector<Obstacle>& t_obstacles)
+{
+	clear();
+
+	std::vector<sf::FloatRect> bounds(t_obstacles.size());
+	std::vector<CircleCollider> colliders(t_obstacles.size());
+	std::vector<sf::Vector2i> minCells(t_obstacles.size());
+	std::vector<sf::Vector2i> maxCells(t_obstacles.size());
+
+	// First pass: count how many objects land in each cell
+	for (std::size_t i = 0; i < t_obstacles.size(); i++)
+	{
+		sf::Sprite const& sprite{ t_obstacles[i].getSprite() };
+
+		bounds[i] = sprite.getGlobalBounds();
+		colliders[i] = { sprite.getPosition(), sprite.getTextureRect().width * COLLIDER_SCALE };
+		getCellRange(bounds[i], minCells[i], maxCells[i]);
+
+		for (int col = minCells[i].x; col <= maxCells[i].x; col++)
+		{
+			for (int row = minCells[i].y; row <= maxCells[i].y; row++)
+			{
+				m_cellStart[CellResolution::getGridRef(col, row) + 1]++;
+			}
+		}
+	}
+
+	// Prefix sum turns the counts into start offsets
+	for (std::size_t cell = 1; cell < m_cellStart.size(); cell++)
+	{
+		m_cellStart[cell] += m_cellStart[cell - 1];
+	}
+
+	m_cellObjects.resize(m_cellStart.back());
+	m_cellBounds.resize(m_cellStart.back());
+	m_cellColliders.resize(m_cellStart.back());
+
+	// Second pass: scatter the objects into their cells
+	std::vector<int> writePos(m_cellStart.begin(), m_cellStart.end() - 1);
+
+	for (std::size_t i = 0; i < t_obstacles.size(); i++)
+	{
+		for (int col = minCells[i].x; col <= maxCells[i].x; col++)
+		{
+			for (int row = minCells[i].y; row <= maxCells[i].y; row++)
+			{
+				int index{ writePos[CellResolution::getGridRef(col, row)]++ };
+
+				m_cellObjects[index] = &t_obstacles[i];
+				m_cellBounds[index] = bounds[i];
+				m_cellColliders[index] = colliders[i];
+			}
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////
+
+int SpatialGrid::insert(GameObject* t_object, Layer t_layer, sf::FloatRect const& t_bounds)
+{
+	int handle;
+
+	if (m_freeProxies.empty())
+	{
+		handle = static_cast<int>(m_proxies.size());
+		m_proxies.push_back(Proxy());
+	}
+	else
+	{
+		handle = m_freeProxies.back();
+		m_freeProxies.pop_back();
+		m_proxies[handle] = Proxy();
+	}
+
+	m_proxies[handle].object = t_object;
+	m_proxies[handle].layer = t_layer;
+
+	update(handle, t_bounds);
+
+	return handle;
+}
+
+////////////////////////////////////////////////////////////
+
+int SpatialGrid::insert(Projectile const* t_projectile, sf::Vector2f t_position)
+{
+	int handle{ insert(nullptr, Projectiles, { t_position, { 0.0f, 0.0f } }) };
+
+	m_proxies[handle].projectile = t_projectile;
+
+	return handle;
+}
+
+////////////////////////////////////////////////////////////
+
+void SpatialGrid::update(int t_proxy, sf::FloatRect const& t_bounds)
+{
+	Proxy& proxy{ m_proxies[t_proxy] };
+	proxy.bounds = t_bounds;
+
+	sf::Vector2i minCell, maxCell;
+	getCellRange(t_bounds, minCell, maxCell);
+
+	// Only touch the cell lists when our footprint actually changes
+	if (minCell != proxy.minCell || maxCell != proxy.maxCell)
+	{
+		unlinkProxy(t_proxy, proxy.minCell, proxy.maxCell);
+		linkProxy(t_proxy, minCell, maxCell);
+
+		proxy.minCell = minCell;
+		proxy.maxCell = maxCell;
+	}
+}
+
+////////////////////////////////////////////////////////////
+
+void SpatialGrid::update(int t_proxy, sf::Vector2f t_position)
+{
+	update(t_proxy, { t_position, { 0.0f, 0.0f } });
+}
+
+////////////////////////////////////////////////////////////
+
+void SpatialGrid::remove(int t_proxy)
+{
+	if (t_proxy < 0 || t_proxy >= static_cast<int>(m_proxies.size())) return;
+
+	Proxy& proxy{ m_proxies[t_proxy] };
+
+	unlinkProxy(t_proxy, proxy.minCell, proxy.maxCell);
+	proxy = Proxy();
+
+	m_freeProxies.push_back(t_proxy);
+}
+
+////////////////////////////////////////////////////////////
+
+void SpatialGrid::linkProxy(int t_proxy, sf::Vector2i t_min, sf::Vector2i t_max)
+{
+	for (int col = t_min.x; col <= t_max.x; col++)
+	{
+		for (int row = t_min.y; row <= t_max.y; row++)
+		{
+			m_dynamicCells[CellResolution::getGridRef(col, row)].push_back(t_proxy);
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////
+
+void SpatialGrid::unlinkProxy(int t_proxy, sf::Vector2i t_min, sf::Vector2i t_max)
+{
+	for (int col = t_min.x; col <= t_max.x; col++)
+	{
+		for (int row = t_min.y; row <= t_max.y; row++)
+		{
+			std::vector<int>& cell{ m_dynamicCells[CellResolution::getGridRef(col, row)] };
+
+			// order within a cell doesn't matter, so swap and pop
+			auto it = std::find(cell.begin(), cell.end(), t_proxy);
+
+			if (it != cell.end())
+			{
+				*it = cell.back();
+				cell.pop_back();
+			}
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////
+
+void SpatialGrid::removeDuplicates(std::vector<GameObject*>& t_results)
+{
+	// each object paired with where it was first seen; one scratch per thread so queries can run side by side
+	thread_local std::vector<std::pair<GameObject*, std::size_t>> sightings;
+
+	sightings.clear();
+
+	for (std::size_t i = 0; i < t_results.size(); i++)
+	{
+		sightings.push_back({ t_results[i], i });
+	}
+
+	// addresses only group the copies together, the first sighting of each is what's kept
+	std::sort(sightings.begin(), sightings.end());
+
+	for (std::size_t i = 1; i < sightings.size(); i++)
+	{
+		if (sightings[i].first == sightings[i - 1].first)
+		{
+			t_results[sightings[i].second] = nullptr;
+		}
+	}
+
+	// what's left stays in the order the cells were visited, so results don't depend on where objects were allocated
+	t_results.erase(std::remove(t_results.begin(), t_results.end(), nullptr), t_results.end());
+}
+
+////////////////////////////////////////////////////////////
+
+void SpatialGrid::queryAABB(sf::FloatRect const& t_area, unsigned t_layers, std::vector<GameObject*>& t_results) const
+{
+	auto test = [&t_area](sf::FloatRect const& t_bounds)
+	{
+		return t_bounds.left <= t_area.left + t_area.width && t_area.left <= t_bounds.left + t_bounds.width &&
+			t_bounds.top <= t_area.top + t_area.height && t_area.top <= t_bounds.top + t_bounds.height;
+	};
+
+	gatherCells(t_area, t_layers, test, t_results);
+}
+
+////////////////////////////////////////////////////////////
+
+void SpatialGrid::queryRadius(sf::Vector2f t_centre, float t_radius, unsigned t_layers, std::vector<GameObject*>& t_results) const
+{
+	const float radiusSquared{ t_radius * t_radius };
+
+	auto test = [t_centre, radiusSquared](sf::FloatRect const& t_bounds)
+	{
+		// distance from the centre to the closest point of the rectangle
+		float dx{ t_centre.x - std::clamp(t_centre.x, t_bounds.left, t_bounds.left + t_bounds.width) };
+		float dy{ t_centre.y - std::clamp(t_centre.y, t_bounds.top, t_bounds.top + t_bounds.height) };
+
+		return dx * dx + dy * dy <= radiusSquared;
+	};
+
+	gatherCells({ t_centre.x - t_radius, t_centre.y - t_radius, t_radius * 2.0f, t_radius * 2.0f }, t_layers, test, t_results);
+}
+
+////////////////////////////////////////////////////////////
+
+void SpatialGrid::querySector(sf::Vector2f t_origin, sf::Vector2f t_heading, float t_halfAngle, float t_range, unsigned t_layers, std::vector<GameObject*>& t_results) const
+{
+	t_results.clear();
+
+	float length{ std::sqrt(t_heading.x * t_heading.x + t_heading.y * t_heading.y) };
+
+	if (length <= 0.0f || t_range <= 0.0f) return;
+
+	const sf::Vector2f heading{ t_heading / length };
+	const float rangeSquared{ t_range * t_range };
+
+	// Everything in range, as for queryRadius
+	sf::FloatRect area{ t_origin.x - t_range, t_origin.y - t_range, t_range * 2.0f, t_range * 2.0f };
+
+	auto inRange = [t_origin, rangeSquared](sf::FloatRect const& t_bounds)
+	{
+		float dx{ t_origin.x - std::clamp(t_origin.x, t_bounds.left, t_bounds.left + t_bounds.width) };
+		float dy{ t_origin.y - std::clamp(t_origin.y, t_bounds.top, t_bounds.top + t_bounds.height) };
+
+		return dx * dx + dy * dy <= rangeSquared;
+	};
+
+	// Wider than a half-plane the sector isn't convex, so settle for the range check
+	if (t_halfAngle >= thor::Pi / 2.0f)
+	{
+		gatherCells(area, t_layers, inRange, t_results);
+		return;
+	}
+
+	// Otherwise it fits in the triangle formed by its straight edges and the tangent to the middle of its arc
+	const float cosine{ std::cos(t_halfAngle) };
+	const float sine{ std::sin(t_halfAngle) };
+	const float edgeLength{ t_range / cosine };
+
+	const sf::Vector2f corners[3]{
+		t_origin,
+		t_origin + sf::Vector2f{ heading.x * cosine - heading.y * sine, heading.y * cosine + heading.x * sine } * edgeLength,
+		t_origin + sf::Vector2f{ heading.x * cosine + heading.y * sine, heading.y * cosine - heading.x * sine } * edgeLength };
+
+	// so only the cells under both the triangle and the range circle need visiting
+	const float left{ std::max(area.left, std::min({ corners[0].x, corners[1].x, corners[2].x })) };
+	const float top{ std::max(area.top, std::min({ corners[0].y, corners[1].y, corners[2].y })) };
+	const float right{ std::min(area.left + area.width, std::max({ corners[0].x, corners[1].x, corners[2].x })) };
+	const float bottom{ std::min(area.top + area.height, std::max({ corners[0].y, corners[1].y, corners[2].y })) };
+
+	// outward normals of the triangle's edges
+	sf::Vector2f normals[3];
+
+	for (int i = 0; i < 3; i++)
+	{
+		sf::Vector2f edge{ corners[(i + 1) % 3] - corners[i] };
+		normals[i] = { edge.y, -edge.x };
+	}
+
+	// flip them if the triangle winds the other way
+	sf::Vector2f toThird{ corners[2] - corners[0] };
+
+	if (normals[0].x * toThird.x + normals[0].y * toThird.y > 0.0f)
+	{
+		for (sf::Vector2f& normal : normals)
+		{
+			normal = -normal;
+		}
+	}
+
+	auto test = [&](sf::FloatRect const& t_bounds)
+	{
+		if (!inRange(t_bounds)) return false;
+
+		// separating axis test of the triangle against the bounds: the bounds' own axes first
+		if (t_bounds.left > right || t_bounds.left + t_bounds.width < left ||
+			t_bounds.top > bottom || t_bounds.top + t_bounds.height < top) return false;
+
+		// then the triangle's edges
+		const float xs[2]{ t_bounds.left, t_bounds.left + t_bounds.width };
+		const float ys[2]{ t_bounds.top, t_bounds.top + t_bounds.height };
+
+		for (int i = 0; i < 3; i++)
+		{
+			// the bounds are clear of this edge if their corner furthest back along the normal is still in front of it
+			float nearX{ (normals[i].x > 0.0f) ? xs[0] : xs[1] };
+			float nearY{ (normals[i].y > 0.0f) ? ys[0] : ys[1] };
+
+			if ((nearX - corners[i].x) * normals[i].x + (nearY - corners[i].y) * normals[i].y > 0.0f) return false;
+		}
+
+		return true;
+	};
+
+	gatherCells({ left, top, right - left, bottom - top }, t_layers, test, t_results);
+}
+
+////////////////////////////////////////////////////////////
+
+void SpatialGrid::queryProjectiles(sf::FloatRect const& t_area, std::vector<Projectile const*>& t_results) const
+{
+	t_results.clear();
+
+	sf::Vector2i minCell, maxCell;
+	getCellRange(t_area, minCell, maxCell);
+
+	for (int col = minCell.x; col <= maxCell.x; col++)
+	{
+		for (int row = minCell.y; row <= maxCell.y; row++)
+		{
+			for (int handle : m_dynamicCells[CellResolution::getGridRef(col, row)])
+			{
+				Proxy const& proxy{ m_proxies[handle] };
+
+				// projectiles are points, so each one lives in exactly one cell
+				if (proxy.projectile && t_area.contains(proxy.bounds.left, proxy.bounds.top))
+				{
+					t_results.push_back(proxy.projectile);
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,27 @@
+#include "SpriteState.h"
+#include "MathUtility.h"
+
+void SpriteState::capture(sf::Sprite const& t_sprite)
+{
+	position = t_sprite.getPosition();
+	rotation = t_sprite.getRotation();
+}
+
+////////////////////////////////////////////////////////////
+
+sf::Sprite SpriteState::blend(sf::Sprite const& t_current, float t_alpha) const
+{
+	sf::Sprite sprite{ t_current };
+
+	sprite.setPosition(blendPosition(t_current, t_alpha));
+	sprite.setRotation(MathUtility::lerpAngle(rotation, t_current.getRotation(), t_alpha));
+
+	return sprite;
+}
+
+////////////////////////////////////////////////////////////
+
+sf::Vector2f SpriteState::blendPosition(sf::Sprite const& t_current, float t_alpha) const
+{
+	return MathUtility::lerp(position, t_current.getPosition(), t_alpha);
+}
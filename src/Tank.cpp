@@ -1,61 +1,34 @@
 #include "Tank.h"
+#include "Profiler.h"
 #include "MathUtility.h"
+#include "ParticleEffects.h"
 #include <iostream>
+#include <algorithm>
 
-Tank::Tank(sf::Texture const& t_texture, std::map<int, std::list<GameObject*>>& t_obstacleMap, std::vector<Target>& t_targetVector, TankAi& t_enemyTank, float& t_screenShake)
+Tank::Tank(sf::Texture const& t_texture, SpatialGrid& t_spatialGrid, float& t_screenShake, EventQueue& t_events, ParticleManager& t_particles, std::mt19937& t_random)
 	: m_texture(t_texture),
-	ref_obstacles(t_obstacleMap),
-	ref_targets(t_targetVector),
-	ref_enemyTank(t_enemyTank),
-	m_screenShake(t_screenShake)
+	ref_spatialGrid(t_spatialGrid),
+	m_screenShake(t_screenShake),
+	ref_events(t_events),
+	ref_particles(t_particles),
+	ref_random(t_random)
 {
 	initSprites();
-	loadParticleTextures();
+	initParticles();
 
 	temp_debugInit();
+
+	m_gridProxy = ref_spatialGrid.insert(this, SpatialGrid::PlayerTank, getFootprint());
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////
 
-void Tank::loadParticleTextures()
+void Tank::initParticles()
 {
-	try
-	{
-		if (!m_smokeTexture.loadFromFile(".\\resources\\images\\smoke.png"))
-		{
-			throw std::exception("Error loading 'smoke.png' from within Tank.cpp >> loadParticleTextures");
-		}
-
-		if (!m_sparkTexture.loadFromFile(".\\resources\\images\\spark.png"))
-		{
-			throw std::exception("Error loading 'spark.png' from within Tank.cpp >> loadParticleTextures");
-		}
-	}
-	catch (std::exception e)
-	{
-		std::cout << e.what() << std::endl;
-	}
-
-	thor::FadeAnimation fade{ 0.0f,1.0f };
-
-	m_smokeParticleSystem.setTexture(m_smokeTexture);
-	m_sparkParticleSystem.setTexture(m_sparkTexture);
-
-	// Spark effects
-	m_sparksEmitter.setEmissionRate(5);
-	m_sparksEmitter.setParticleVelocity(thor::Distributions::deflect({ 30.0f,30.0f }, 180.0f));
-	m_sparksEmitter.setParticleLifetime(thor::Distributions::uniform(sf::seconds(0.1f), sf::seconds(1.5f)));
-
-	m_sparkParticleSystem.addAffector(thor::AnimationAffector(fade));
-
-	// Smoke effects
-	m_smokeEmitter.setEmissionRate(m_smokeEmissionRate);
-	m_smokeEmitter.setParticleVelocity(thor::Distributions::deflect({ 30.0f,30.0f }, 360.0f));
-	m_smokeEmitter.setParticleLifetime(thor::Distributions::uniform(sf::seconds(0.1f), sf::seconds(1.5f)));
-
-	thor::ScaleAffector scale({ 1.1f,1.25f });
-	m_smokeParticleSystem.addAffector(scale);
-	m_smokeParticleSystem.addAffector(thor::AnimationAffector(fade));
+	// one emitter each, moved along with us; updateParticles switches them on as we take damage
+	m_leftTrackSparks = ref_particles.addPersistentEmitter(ParticleEffects::TRACK_SPARKS, false);
+	m_rightTrackSparks = ref_particles.addPersistentEmitter(ParticleEffects::TRACK_SPARKS, false);
+	m_smokeEmitter = ref_particles.addPersistentEmitter(ParticleEffects::ENGINE_SMOKE, false);
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////
@@ -67,10 +40,12 @@ void Tank::reset()
 	m_speed = 0.0;
 	m_smokeEmissionRate = 0;
 
-	m_smokeParticleSystem.clearEmitters();
-	m_sparkParticleSystem.clearEmitters();
+	// the particle systems are shared, so only switch off our own emitters
+	ref_particles.setEmitterEnabled(m_leftTrackSparks, false);
+	ref_particles.setEmitterEnabled(m_rightTrackSparks, false);
+	ref_particles.setEmitterEnabled(m_smokeEmitter, false);
 
-	m_smokeEmitter.setEmissionRate(0);
+	ref_particles.getEmitter(m_smokeEmitter).emissionRate = 0.0f;
 
 	m_damageLevels.reset();
 	m_damageClock.reset();
@@ -82,6 +57,12 @@ void Tank::setPosition(sf::Vector2f const& m_pos)
 {
 	m_tankBase.setPosition(m_pos);
 	m_turret.setPosition(m_pos);
+
+	// a teleport, not movement; don't draw the tank sliding across the map
+	m_lastBaseState.capture(m_tankBase);
+	m_lastTurretState.capture(m_turret);
+
+	ref_spatialGrid.update(m_gridProxy, getFootprint());
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////
@@ -97,22 +78,18 @@ void Tank::temp_debugInit()
 
 bool Tank::checkWallCollision()
 {
-	for (auto& wall : m_obstacles)
-	{
-		// Checks if either the tank base or turret has collided with the current wall sprite.
-		if (CollisionDetector::collision(m_turret, wall->getSprite()) ||
-			CollisionDetector::collision(m_tankBase, wall->getSprite()))
-		{
-			return true;
-		}
-	}
-	return false;
+	// Checks if either the tank base or turret has collided with any nearby wall.
+	return CollisionDetector::collision(getTurretBoundingBox(), m_obstacleBoxes, m_wallHits) > 0 ||
+		CollisionDetector::collision(getBaseBoundingBox(), m_obstacleBoxes, m_wallHits) > 0;
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////
 
 void Tank::checkTargetCollision()
 {
+	// ask the grid directly, targets may have been swapped out since our last update
+	ref_spatialGrid.queryAABB(getFootprint(), SpatialGrid::Targets, m_targets);
+
 	for (GameObject* t : m_targets)
 	{
 		sf::FloatRect bounds{ t->getSprite().getGlobalBounds() };
@@ -179,11 +156,11 @@ void Tank::adjustRotation()
 
 ///////////////////////////////////////////////////////////////////////////////////////////////
 
-void Tank::increaseSpeed()
+void Tank::increaseSpeed(sf::Time t_dt)
 {
 	if (m_speed < (M_MAX_SPEED - 1.0f))
 	{
-		m_speed += 0.6f;
+		m_speed += M_ACCELERATION * t_dt.asSeconds();
 	}
 	else
 	{
@@ -194,11 +171,11 @@ void Tank::increaseSpeed()
 
 ///////////////////////////////////////////////////////////////////////////////////////////////
 
-void Tank::decreaseSpeed()
+void Tank::decreaseSpeed(sf::Time t_dt)
 {
 	if (m_speed > (M_MIN_SPEED + 1.0f))
 	{
-		m_speed -= 0.6f;
+		m_speed -= M_ACCELERATION * t_dt.asSeconds();
 	}
 	else
 	{
@@ -208,10 +185,11 @@ void Tank::decreaseSpeed()
 
 ///////////////////////////////////////////////////////////////////////////////////////////////
 
-void Tank::increaseRotation()
+void Tank::increaseRotation(sf::Time t_dt)
 {
 	// Decrease turn rate if our track is damaged
-	double rotateBy{ (m_damageLevels.m_leftTrackDamaged || m_damageLevels.m_rightTrackDamaged) ? 0.5 : 1.0f };
+	double turnRate{ (m_damageLevels.m_leftTrackDamaged || m_damageLevels.m_rightTrackDamaged) ? M_TURN_RATE / 2.0f : M_TURN_RATE };
+	double rotateBy{ turnRate * t_dt.asSeconds() };
 
 	m_previousBaseRotation = m_baseRotation;
 	(m_baseRotation > 360.0) ? m_baseRotation -= 360.0 : m_baseRotation += rotateBy;
@@ -219,10 +197,11 @@ void Tank::increaseRotation()
 
 ///////////////////////////////////////////////////////////////////////////////////////////////
 
-void Tank::decreaseRotation()
+void Tank::decreaseRotation(sf::Time t_dt)
 {
 	// Decrease turn rate if our track is damaged
-	double rotateBy{ (m_damageLevels.m_leftTrackDamaged || m_damageLevels.m_rightTrackDamaged) ? 0.5 : 1.0f };
+	double turnRate{ (m_damageLevels.m_leftTrackDamaged || m_damageLevels.m_rightTrackDamaged) ? M_TURN_RATE / 2.0f : M_TURN_RATE };
+	double rotateBy{ turnRate * t_dt.asSeconds() };
 
 	m_previousBaseRotation = m_baseRotation;
 	(m_baseRotation < 0.0) ? m_baseRotation += 360.0 : m_baseRotation -= rotateBy;
@@ -259,24 +238,24 @@ void Tank::toggleTurretFree()
 
 void Tank::hit()
 {
-	std::cout << "I'm hit!" << std::endl;
-
 	(m_screenShake < 0.5f) ? m_screenShake += 0.5f : m_screenShake = 1.0f;
 
 	// Increase the amount of smoke coming from our tank
 	(m_smokeEmissionRate < 10) ? m_smokeEmissionRate++ : m_smokeEmissionRate = 10;
-	m_smokeEmitter.setEmissionRate(m_smokeEmissionRate);
+	ref_particles.getEmitter(m_smokeEmitter).emissionRate = m_smokeEmissionRate * SMOKE_PER_HIT;
 
 	m_health -= 10.0f;
 
+	ref_events.push_back({ GameEvent::Type::PlayerHit, position() });
+
 	// If neither track is damaged
 	if (!m_damageLevels.m_leftTrackDamaged && !m_damageLevels.m_rightTrackDamaged)
 	{
 		// 1 in 3 chance of damaging a track
-		if (1 == rand() % 3)
+		if (0 == std::uniform_int_distribution<int>(0, 2)(ref_random))
 		{
 			// flip a coin to decide which side is damaged
-			if (1 == rand() % 2)
+			if (std::bernoulli_distribution()(ref_random))
 			{
 				m_damageLevels.m_leftTrackDamaged = true;
 			}
@@ -295,7 +274,16 @@ void Tank::hit()
 
 void Tank::update(sf::Time dt)
 {
-	updateParticles(dt);
+	PROFILE_SCOPE("Tank::update");
+
+	m_damageClock.update(dt);
+
+	m_lastBaseState.capture(m_tankBase);
+	m_lastTurretState.capture(m_turret);
+
+#ifndef HEADLESS
+	updateParticles();
+#endif
 
 	// keep track of previous position
 	m_previousPosition = m_tankBase.getPosition();
@@ -334,28 +322,28 @@ void Tank::update(sf::Time dt)
 		}
 	}
 
-	// Pull the steering if one track is damaged
+	// Pull the steering if one track is damaged (degrees per second)
 	float steeringOffset{ 0.0f };
 
 	if (m_damageLevels.m_leftTrackDamaged)
 	{
-		steeringOffset = 0.2f;
+		steeringOffset = 12.0f;
 	}
 	else if (m_damageLevels.m_rightTrackDamaged)
 	{
-		steeringOffset = -0.2f;
+		steeringOffset = -12.0f;
 	}
 
 	if (m_speed > 0.0)
 	{
-		m_speed -= M_FRICTION;
-		m_baseRotation -= steeringOffset;
+		m_speed -= M_FRICTION * dt.asSeconds();
+		m_baseRotation -= steeringOffset * dt.asSeconds();
 	}
 
 	if (m_speed < 0.0)
 	{
-		m_speed += M_FRICTION;
-		m_baseRotation += steeringOffset;
+		m_speed += M_FRICTION * dt.asSeconds();
+		m_baseRotation += steeringOffset * dt.asSeconds();
 	}
 
 	updateGameObjects();
@@ -363,20 +351,17 @@ void Tank::update(sf::Time dt)
 
 ///////////////////////////////////////////////////////////////////////////////////////////////
 
-void Tank::render(sf::RenderWindow & window) 
+void Tank::render(sf::RenderWindow & window, float t_alpha) 
 {
-	window.draw(m_smokeParticleSystem);
-	window.draw(m_sparkParticleSystem);
-
-	window.draw(m_tankBase);
-	window.draw(m_turret);	
+	window.draw(m_lastBaseState.blend(m_tankBase, t_alpha));
+	window.draw(m_lastTurretState.blend(m_turret, t_alpha));
 
 	if (DEBUG_mode)
 	{
 		// DEBUG highlight active cells TEMP
 		for (int i : m_activeCells)
 		{
-			temp_activeCellRect.setPosition({ (i / 10) * CellResolution::temp_getCellSize().x, i % 10 * CellResolution::temp_getCellSize().y });
+			temp_activeCellRect.setPosition(CellResolution::getCellPosition(i));
 			window.draw(temp_activeCellRect);
 		}
 	}
@@ -405,12 +390,8 @@ void Tank::initSprites()
 
 void Tank::updateGameObjects()
 {
-	m_obstacles.clear();
-	m_targets.clear();
-	m_enemyTanks.clear();
-
 	// work out which cells we occupy
-	m_activeCells.clear();
+	m_nextCells.clear();
 
 	int gridPos{ -1 };
 
@@ -422,7 +403,7 @@ void Tank::updateGameObjects()
 		// If we get an error value back, don't add to set
 		if (gridPos == -1) continue;
 
-		m_activeCells.insert(gridPos);
+		m_nextCells.push_back(gridPos);
 	}
 	
 	for (sf::Vector2f pos : CellResolution::getCorners(m_turret))
@@ -432,45 +413,73 @@ void Tank::updateGameObjects()
 		// If we get an error value back, don't add to set
 		if (gridPos == -1) continue;
 
-		m_activeCells.insert(gridPos);
+		m_nextCells.push_back(gridPos);
 	}
 
-	// populate our vector of obstacle pointers
-	for (int i : m_activeCells)
+	std::sort(m_nextCells.begin(), m_nextCells.end());
+	m_nextCells.erase(std::unique(m_nextCells.begin(), m_nextCells.end()), m_nextCells.end());
+
+	// walls never move, so the nearby set and their cached boxes only change when we cross into different cells
+	if (m_nextCells != m_activeCells)
 	{
-		// will return 0 if key not in map
-		if (ref_obstacles.count(i))
-		{ 
-			for (GameObject* obj : ref_obstacles.at(i))
+		m_activeCells.swap(m_nextCells);
+		m_obstacles.clear();
+
+		// populate our vector of obstacle pointers
+		for (int i : m_activeCells)
+		{
+			// empty span if nothing occupies this cell
+			for (GameObject* obj : ref_spatialGrid.getCell(i))
 			{
 				m_obstacles.push_back(obj);
 			}
 		}
-	}
 
-	// populate our vector of target pointers
-	for (Target& i : ref_targets)
-	{
-		m_targets.push_back(&i);
+		// walls spanning several of our cells would otherwise be tested more than once
+		SpatialGrid::removeDuplicates(m_obstacles);
+
+		m_obstacleBoxes.Clear();
+
+		for (GameObject* obj : m_obstacles)
+		{
+			m_obstacleBoxes.Add(obj->getBoundingBox());
+		}
 	}
 
-	// populate our vector of tank pointers (right now it's just one!)
-	m_enemyTanks.push_back(&ref_enemyTank);
+	sf::FloatRect footprint{ getFootprint() };
+
+	// let the grid know where we are now; it only re-buckets us if we changed cells
+	ref_spatialGrid.update(m_gridProxy, footprint);
+
+	// populate our vector of nearby tank pointers
+	ref_spatialGrid.queryAABB(footprint, SpatialGrid::EnemyTanks, m_enemyTanks);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////
+
+sf::FloatRect Tank::getFootprint() const
+{
+	return MathUtility::unite(m_tankBase.getGlobalBounds(), m_turret.getGlobalBounds());
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////
 
-void Tank::updateParticles(sf::Time t_dt)
+void Tank::updateParticles()
 {
-	// Update position for particle FX
+	PROFILE_SCOPE("Tank::updateParticles");
+
+	// Keep the emitters with us; they're only switched on while there's damage to show
+	ref_particles.setEmitterEnabled(m_leftTrackSparks, m_damageLevels.m_leftTrackDamaged);
+	ref_particles.setEmitterEnabled(m_rightTrackSparks, m_damageLevels.m_rightTrackDamaged);
+	ref_particles.setEmitterEnabled(m_smokeEmitter, m_smokeEmissionRate > 0);
+
 	if (m_damageLevels.m_leftTrackDamaged)
 	{
 		// 90 degrees off our rotation; portside of the tank
 		float deltaAngle{ thor::toRadian(m_baseRotation - 90.0f) };
 		sf::Vector2f leftTrack{ std::cos(deltaAngle) * 20.0f, std::sin(deltaAngle) * 20.0f };
 
-		m_sparksEmitter.setParticlePosition(m_turret.getPosition() + leftTrack);
-		m_sparkParticleSystem.addEmitter(m_sparksEmitter, sf::seconds(0.5f));
+		ref_particles.getEmitter(m_leftTrackSparks).position = m_turret.getPosition() + leftTrack;
 	}
 	
 	if (m_damageLevels.m_rightTrackDamaged)
@@ -479,13 +488,8 @@ void Tank::updateParticles(sf::Time t_dt)
 		float deltaAngle = thor::toRadian(m_baseRotation + 90.0f);
 		sf::Vector2f rightTrack{ std::cos(deltaAngle) * 20.0f, std::sin(deltaAngle) * 20.0f };
 
-		m_sparksEmitter.setParticlePosition(m_turret.getPosition() + rightTrack);
-		m_sparkParticleSystem.addEmitter(m_sparksEmitter, sf::seconds(0.5f));
+		ref_particles.getEmitter(m_rightTrackSparks).position = m_turret.getPosition() + rightTrack;
 	}
 
-	m_smokeEmitter.setParticlePosition(m_turret.getPosition());
-	m_smokeParticleSystem.addEmitter(m_smokeEmitter, sf::seconds(0.5f));
-
-	m_smokeParticleSystem.update(t_dt);
-	m_sparkParticleSystem.update(t_dt);
+	ref_particles.getEmitter(m_smokeEmitter).position = m_turret.getPosition();
 }
\ No newline at end of file
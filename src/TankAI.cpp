@@ -1,22 +1,29 @@
 #include "TankAi.h"
+#include "Profiler.h"
+#include "ParticleEffects.h"
+#include <chrono>
 
 ////////////////////////////////////////////////////////////
 
-TankAi::TankAi(sf::Texture const& texture, std::map<int, std::list<GameObject*>>& t_obstacleMap, std::vector<Obstacle>& t_obstacleVector, float& t_screenShake) :
+TankAi::TankAi(sf::Texture const& texture, SpatialGrid& t_spatialGrid, FlowField const& t_flowField, NavMesh const& t_navMesh, float& t_screenShake, EventQueue& t_events, ParticleManager& t_particles, std::mt19937& t_random) :
 	m_texture(texture)
-	, ref_obstacleMap(t_obstacleMap)
-	, ref_obstacleVector(t_obstacleVector)
+	, ref_spatialGrid(t_spatialGrid)
+	, ref_flowField(t_flowField)
+	, ref_navMesh(t_navMesh)
 	, m_steering(0, 0)
 	, m_screenShake(t_screenShake)
+	, ref_events(t_events)
+	, ref_particles(t_particles)
+	, m_random(t_random())
 {
 	// Initialises the tank base and turret sprites.
 	initSprites();
 	initVisionCone();
 
-	f_projectileImpact = &TankAi::projectileImpact;
-	f_impactSmoke = &TankAi::impactSmoke;
-
 	m_patrolTargetBounds.setOrigin(20.0f, 20.0f);
+
+	m_projectilePool.setSpatialGrid(ref_spatialGrid);
+	m_gridProxy = ref_spatialGrid.insert(this, SpatialGrid::EnemyTanks, getFootprint());
 }
 
 ////////////////////////////////////////////////////////////
@@ -26,8 +33,20 @@ void TankAi::init(sf::Vector2f position)
 	m_tankBase.setPosition(position);
 	m_turret.setPosition(position);
 
-	m_smokeParticleSystem.clearEmitters();
-	m_sparkParticleSystem.clearEmitters();
+	m_lastBaseState.capture(m_tankBase);
+	m_lastTurretState.capture(m_turret);
+
+	ref_spatialGrid.update(m_gridProxy, getFootprint());
+
+	// nothing seen yet; the cone grows back on our first look
+	for (std::size_t i = 0; i < m_visionCone.getVertexCount(); i++)
+	{
+		m_visionCone[i].position = position;
+	}
+
+	m_visionOrigin = position;
+
+	m_pendingImpactSmoke.clear();
 
 	// Stop and restart the stopwatch
 	m_playerLastSeen.reset();
@@ -42,27 +61,6 @@ void TankAi::init(sf::Vector2f position)
 
 void TankAi::initSprites()
 {
-	try
-	{
-		if (!m_smokeTexture.loadFromFile(".\\resources\\images\\smoke.png"))
-		{
-			throw std::exception("Error loading 'smoke.png' from within TankAi.cpp >> initSprites");
-		}
-
-		if (!m_sparkTexture.loadFromFile(".\\resources\\images\\spark.png"))
-		{
-			throw std::exception("Error loading 'spark.png' from within TankAi.cpp >> initSprites");
-		}
-	}
-	catch (std::exception e)
-	{
-		std::cout << e.what() << std::endl;
-	}
-
-	m_impactParticleSystem.setTexture(m_smokeTexture);
-	m_smokeParticleSystem.setTexture(m_smokeTexture);
-	m_sparkParticleSystem.setTexture(m_sparkTexture);
-
 	// Initialise the tank base
 	m_tankBase.setTexture(m_texture);
 	sf::IntRect baseRect(103, 43, 79, 43);
@@ -96,35 +94,38 @@ void TankAi::initVisionCone()
 
 void TankAi::update(Tank& playerTank, sf::Time dt)
 {
-	updateGameObjects();
-	m_projectilePool.update(dt);
+	PROFILE_SCOPE("TankAi::update");
 
-	// Update the float rect of the player tank
-	m_playerTankRect = playerTank.getSprite().getGlobalBounds();
+	m_playerLastSeen.update(dt);
+	m_fireClock.update(dt);
 
-	// We could use if (frameCount % 2) to run this only every second frame, if we ran into speed issues.
-	// It's performing perfectly fine for me at the moment though, so I decided there's no need
-	updateVisionCone();
+	m_lastBaseState.capture(m_tankBase);
+	m_lastTurretState.capture(m_turret);
 
-	GameObject* tank = &playerTank;
-	std::vector<GameObject*> tankVec{ tank };
+	m_projectilePool.update(dt);
 
-	m_projectilePool.checkCollisions(m_obstaclesInPartition, f_projectileImpact, this);
-	m_projectilePool.checkCollisions(tankVec, f_projectileImpact, this);
+	// Looking around is the expensive part of an update, so GameWorld's scheduler decides when we do it;
+	// in between we steer by the obstacles and act on the sightings from our last look
+	m_perceptionCost = sf::Time::Zero;
 
-	// update particles
-	// (these functions sometimes throw internal exceptions)
-	try
+	if (m_perceiving)
 	{
-		m_smokeParticleSystem.update(dt);
-		m_sparkParticleSystem.update(dt);
-		m_impactParticleSystem.update(dt);
-	}
-	catch (std::exception& e)
-	{
-		std::cout << e.what() << std::endl;
+		PROFILE_SCOPE("TankAi::perception");
+
+		auto start{ std::chrono::steady_clock::now() };
+
+		updateGameObjects();
+
+		// Take a copy of the player's box (already up to date, so this only reads it)
+		m_playerBox = playerTank.getBoundingBox();
+
+		updateVisionCone();
+
+		m_perceptionCost = sf::microseconds(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
 	}
 
+	m_projectilePool.checkCollisions(SpatialGrid::Obstacles | SpatialGrid::PlayerTank, m_commands.hits);
+
 	if (m_playerLastSeen.getElapsedTime() < m_timeToLosePlayer)
 	{
 		vectorToPlayer = seek(playerTank.getSprite().getPosition());
@@ -136,12 +137,12 @@ void TankAi::update(Tank& playerTank, sf::Time dt)
 	case AIState::PATROL_MAP:
 
 		// Spin our vision cone
-		m_visionConeRotation++;
+		m_visionConeRotation += VISION_SWEEP_RATE * dt.asSeconds();
 
 		m_visionDistance = 300.0f;
 
-		// Drive towards our target
-		driveTo(seek(m_patrolTarget));
+		// Drive towards our target, round the rocks
+		driveTo(seek(nextPatrolWaypoint()));
 
 		// If we hit our target
 		if (m_tankBase.getGlobalBounds().intersects(m_patrolTargetBounds.getGlobalBounds()))
@@ -161,7 +162,7 @@ void TankAi::update(Tank& playerTank, sf::Time dt)
 		m_visionConeRotation = m_turretRotation;
 
 		aimTurret(vectorToPlayer);
-		driveTo(vectorToPlayer);
+		driveTo(routeToPlayer());
 
 		steer();
 
@@ -191,6 +192,7 @@ void TankAi::update(Tank& playerTank, sf::Time dt)
 			fire();
 			m_fireClock.restart();
 		}
+		break;
 	default:
 		break;
 	}
@@ -200,8 +202,6 @@ void TankAi::update(Tank& playerTank, sf::Time dt)
 	// If we haven't seen the player in (time) seconds
 	if (m_playerLastSeen.getElapsedTime() > m_timeToLosePlayer)
 	{
-		std::cout << "I've lost the player. Returning to patrol." << std::endl;
-
 		// Stop and restart the stopwatch
 		m_playerLastSeen.reset();
 
@@ -230,6 +230,41 @@ void TankAi::update(Tank& playerTank, sf::Time dt)
 
 ////////////////////////////////////////////////////////////
 
+void TankAi::commit()
+{
+	for (ProjectileHit const& hit : m_commands.hits)
+	{
+		projectileImpact(hit.position);
+
+		// tell our object it's been hit
+		hit.target->hit();
+	}
+
+	if (m_commands.fired)
+	{
+#ifndef HEADLESS
+		muzzleFlash(m_commands.fireDirection);
+#endif
+
+		// Shake the screen
+		(m_screenShake < 0.5f) ? m_screenShake += 0.25f : m_screenShake = 0.5f;
+
+		ref_events.push_back({ GameEvent::Type::EnemyFired, m_commands.firePosition });
+	}
+
+	m_commands.fired = false;
+	m_commands.hits.clear();
+
+	ref_spatialGrid.update(m_gridProxy, getFootprint());
+	m_projectilePool.syncGrid();
+
+#ifndef HEADLESS
+	spawnPendingEffects();
+#endif
+}
+
+////////////////////////////////////////////////////////////
+
 void TankAi::aimTurret(sf::Vector2f t_playerPos)
 {
 	// Point our gun at the player
@@ -246,16 +281,60 @@ void TankAi::driveTo(sf::Vector2f t_navPos)
 
 ////////////////////////////////////////////////////////////
 
+sf::Vector2f TankAi::routeToPlayer() const
+{
+	sf::Vector2f direction{ ref_flowField.getDirection(m_tankBase.getPosition()) };
+
+	return (direction == sf::Vector2f{ 0.0f, 0.0f }) ? vectorToPlayer : direction;
+}
+
+////////////////////////////////////////////////////////////
+
 void TankAi::choosePatrolTarget()
 {
 	// Choose a target within the bounds of our patrol zone
-	float xPos = static_cast<float>(rand() % (static_cast<int>(m_patrolZone.width)) + m_patrolZone.left);
-	float yPos = static_cast<float>(rand() % (static_cast<int>(m_patrolZone.height)) + m_patrolZone.top);
+	std::uniform_int_distribution<int> xOffset(0, static_cast<int>(m_patrolZone.width) - 1);
+	std::uniform_int_distribution<int> yOffset(0, static_cast<int>(m_patrolZone.height) - 1);
+
+	float xPos{ 0.0f };
+	float yPos{ 0.0f };
+
+	// Targets inside a rock, or somewhere walled off, have no route; try again
+	for (int pick = 0; pick < MAX_PATROL_PICKS; pick++)
+	{
+		xPos = static_cast<float>(xOffset(m_random) + m_patrolZone.left);
+		yPos = static_cast<float>(yOffset(m_random) + m_patrolZone.top);
+
+		if (ref_navMesh.findPath(m_tankBase.getPosition(), { xPos, yPos }, m_patrolPath))
+		{
+			break;
+		}
+	}
+
+	// no luck, so just head straight for the last pick
+	if (m_patrolPath.empty())
+	{
+		m_patrolPath.push_back({ xPos, yPos });
+	}
+
+	m_patrolWaypoint = 0;
 
 	m_patrolTarget = { xPos, yPos };
 	m_patrolTargetBounds.setPosition(m_patrolTarget);
+}
+
+////////////////////////////////////////////////////////////
+
+sf::Vector2f TankAi::nextPatrolWaypoint()
+{
+	sf::Vector2f waypoint{ m_patrolPath[m_patrolWaypoint] };
+
+	if (m_patrolWaypoint + 1 < m_patrolPath.size() && thor::length(waypoint - m_tankBase.getPosition()) < WAYPOINT_RADIUS)
+	{
+		waypoint = m_patrolPath[++m_patrolWaypoint];
+	}
 
-	std::cout << "New patrol target: {" << xPos << ", " << yPos << "}" << std::endl;
+	return waypoint;
 }
 
 ////////////////////////////////////////////////////////////
@@ -315,26 +394,47 @@ void TankAi::updateMovement(sf::Time dt)
 
 ////////////////////////////////////////////////////////////
 
-void TankAi::render(sf::RenderWindow& window)
+void TankAi::render(sf::RenderWindow& window, float t_alpha)
 {
-	m_projectilePool.render(window);
+	m_projectilePool.render(window, t_alpha);
 
 	// TODO: Don't draw if off-screen...
-	window.draw(m_tankBase);
+	window.draw(m_lastBaseState.blend(m_tankBase, t_alpha));
 
-	window.draw(m_visionCone);
+	// the cone is built in world space whenever we look, so shift it from where it was built to where we're drawn
+	sf::RenderStates coneStates;
+	coneStates.transform.translate(m_lastBaseState.blendPosition(m_tankBase, t_alpha) - m_visionOrigin);
 
-	window.draw(m_turret);
+	window.draw(m_visionCone, coneStates);
 
-	window.draw(m_impactParticleSystem);
-	window.draw(m_smokeParticleSystem);
-	window.draw(m_sparkParticleSystem);
+	window.draw(m_lastTurretState.blend(m_turret, t_alpha));
 
 	if (DEBUG_mode)
 	{
-		for (sf::CircleShape& c : m_obstacleColliders)
+		// only built for drawing; avoidance works on the plain colliders
+		sf::CircleShape colliderShape;
+		colliderShape.setFillColor(sf::Color(255, 255, 255, 128));
+
+		for (SpatialGrid::CircleCollider const& c : m_obstacleColliders)
+		{
+			colliderShape.setRadius(c.radius);
+			colliderShape.setOrigin(c.radius, c.radius);
+			colliderShape.setPosition(c.centre);
+			window.draw(colliderShape);
+		}
+
+		// Draw the rest of my patrol route
+		if (AIState::PATROL_MAP == m_currentState)
 		{
-			window.draw(c);
+			sf::VertexArray route(sf::LineStrip);
+			route.append(sf::Vertex(m_tankBase.getPosition(), sf::Color::Cyan));
+
+			for (std::size_t i = m_patrolWaypoint; i < m_patrolPath.size(); i++)
+			{
+				route.append(sf::Vertex(m_patrolPath[i], sf::Color::Cyan));
+			}
+
+			window.draw(route);
 		}
 
 		// DEBUG STUFF
@@ -372,15 +472,12 @@ void TankAi::fire()
 			static_cast<float>(sin(MathUtility::DEG_TO_RAD * m_turretRotation))
 		};
 
-		m_projectilePool.create(m_turret.getPosition(), targetVector, 240);
+		m_projectilePool.create(m_turret.getPosition(), targetVector, SHELL_LIFETIME);
 
-		muzzleFlash(targetVector);
-
-		// Shake the screen
-		(m_screenShake < 0.5f) ? m_screenShake += 0.25f : m_screenShake = 0.5f;
-
-		m_firingSound.setPosition(sf::Vector3f{ m_tankBase.getPosition().x, m_tankBase.getPosition().y, 0.0f });
-		m_firingSound.play();
+		// the flash, screenshake and sound wait for commit()
+		m_commands.fired = true;
+		m_commands.firePosition = m_tankBase.getPosition();
+		m_commands.fireDirection = targetVector;
 }
 
 ////////////////////////////////////////////////////////////
@@ -391,44 +488,47 @@ sf::Vector2f TankAi::collisionAvoidance()
 	sf::Vector2f headingVector(std::cosf(headingRadians) * MAX_SEE_AHEAD, std::sinf(headingRadians) * MAX_SEE_AHEAD);
 	m_ahead = m_tankBase.getPosition() + headingVector;
 	m_halfAhead = m_tankBase.getPosition() + (headingVector * 0.5f);
-	const sf::CircleShape mostThreatening = findMostThreateningObstacle();
+	const int mostThreatening = findMostThreateningObstacle();
 	sf::Vector2f avoidance(0, 0);
 
-	if (MathUtility::lineIntersectsCircle(m_ahead, m_halfAhead, mostThreatening))
-	{		
-		avoidance.x = m_ahead.x - mostThreatening.getPosition().x;
-		avoidance.y = m_ahead.y - mostThreatening.getPosition().y;
-		avoidance = thor::unitVector(avoidance);
-		avoidance *= MAX_AVOID_FORCE;
-	}
-	else
+	if (mostThreatening != -1)
 	{
-		avoidance *= 0.0f;
+		avoidance = m_ahead - m_obstacleColliders[mostThreatening].centre;
+
+		if (avoidance != sf::Vector2f(0, 0))
+		{
+			avoidance = thor::unitVector(avoidance);
+			avoidance *= MAX_AVOID_FORCE;
+		}
 	}
+
 	return avoidance;
 }
 
 ////////////////////////////////////////////////////////////
 
-const sf::CircleShape TankAi::findMostThreateningObstacle()
+int TankAi::findMostThreateningObstacle() const
 {
-	sf::CircleShape mostThreatening;
-	
-	if (m_obstacleColliders.size())
+	int mostThreatening{ -1 };
+	float nearestSquared{ 0.0f };
+
+	for (std::size_t i = 0; i < m_obstacleColliders.size(); i++)
 	{
-		mostThreatening = m_obstacleColliders.at(0);
+		SpatialGrid::CircleCollider const& c{ m_obstacleColliders[i] };
+
+		// only obstacles we're heading into are a threat
+		if (!MathUtility::lineIntersectsCircle(m_ahead, m_halfAhead, c.centre, c.radius)) continue;
+
+		// if this object is closer than our most threatening
+		float distanceSquared{ thor::squaredLength(c.centre - m_tankBase.getPosition()) };
 
-		for (sf::CircleShape c : m_obstacleColliders)
+		if (mostThreatening == -1 || distanceSquared < nearestSquared)
 		{
-			// if this object is closer than our most threatening
-			if (thor::length(c.getPosition() - m_tankBase.getPosition()) < 
-				thor::length(mostThreatening.getPosition() - m_tankBase.getPosition()))
-			{
-				mostThreatening = c;
-			}
+			mostThreatening = static_cast<int>(i);
+			nearestSquared = distanceSquared;
 		}
 	}
-	
+
 	return mostThreatening;
 }
 
@@ -437,8 +537,8 @@ const sf::CircleShape TankAi::findMostThreateningObstacle()
 bool TankAi::collidesWithPlayer(Tank const& playerTank) const
 {
 	// Checks if the AI tank has collided with the player tank.
-	if (CollisionDetector::collision(m_turret, playerTank.getTurret()) ||
-		CollisionDetector::collision(m_tankBase, playerTank.getBase()))
+	if (CollisionDetector::collision(getTurretBoundingBox(), playerTank.getTurretBoundingBox()) ||
+		CollisionDetector::collision(getBaseBoundingBox(), playerTank.getBaseBoundingBox()))
 	{
 		return true;
 	}
@@ -449,21 +549,18 @@ bool TankAi::collidesWithPlayer(Tank const& playerTank) const
 
 void TankAi::hit()
 {
-	std::cout << "\n*~~~~~~~~~~~~~~~~*" << std::endl;
-	std::cout << "* enemy tank hit *" << std::endl;
-	std::cout << "*~~~~~~~~~~~~~~~~*\n" << std::endl;
+	ref_events.push_back({ GameEvent::Type::EnemyHit, m_tankBase.getPosition() });
 }
 
 ////////////////////////////////////////////////////////////
 
 void TankAi::updateGameObjects()
 {
+	PROFILE_SCOPE("TankAi::updateGameObjects");
+
 	// clear our array of circles
 	m_obstacleColliders.clear();
 
-	// Clear elements from last check
-	m_obstaclesInPartition.clear();
-
 	// work out which cells we occupy
 	m_activeCells.clear();
 
@@ -477,7 +574,7 @@ void TankAi::updateGameObjects()
 		// If we get an error value back, don't add to set
 		if (gridPos == -1) continue;
 
-		m_activeCells.insert(gridPos);
+		m_activeCells.push_back(gridPos);
 	}
 
 	// add positions for tank turret
@@ -488,63 +585,22 @@ void TankAi::updateGameObjects()
 		// If we get an error value back, don't add to set
 		if (gridPos == -1) continue;
 
-		m_activeCells.insert(gridPos);
+		m_activeCells.push_back(gridPos);
 	}
 
-	// add positions of projectiles
-	for (sf::Vector2f pos : m_projectilePool.getActiveProjectilePos())
-	{
-		gridPos = CellResolution::getGridRef(pos);
-
-		// If we get an error value back, don't add to set
-		if (gridPos == -1) continue;
-
-		m_activeCells.insert(gridPos);
-	}
-
-	// populate our vector of obstacle bounding circles
-	for (int i : m_activeCells)
-	{
-		// will return 0 if key not in map
-		if (ref_obstacleMap.count(i))
-		{
-			for (GameObject* obj : ref_obstacleMap.at(i))
-			{
-				sf::CircleShape circle(obj->getSprite().getTextureRect().width * 1.5f);
-				circle.setOrigin(circle.getRadius(), circle.getRadius());
-				circle.setPosition(obj->getSprite().getPosition());
-
-				circle.setFillColor(sf::Color(255, 255, 255, 128));
-				m_obstacleColliders.push_back(circle);
-			}
-		}
-	}
+	std::sort(m_activeCells.begin(), m_activeCells.end());
+	m_activeCells.erase(std::unique(m_activeCells.begin(), m_activeCells.end()), m_activeCells.end());
 
-	// populate our vector of obstacle pointers for collision checking
+	// copy out the obstacles' avoidance circles, worked out once when the grid was built
 	for (int i : m_activeCells)
 	{
-		// will return 0 if key not in map
-		if (ref_obstacleMap.count(i))
-		{
-			for (GameObject* obj : ref_obstacleMap.at(i))
-			{
-				m_obstaclesInPartition.push_back(obj);
-			}
-		}
-	}
-
-	// Clear the obstacles from the last frame
-	m_obstaclesInCone.clear();
-
-	// Determine which objects are in our vision cone
-	for (Obstacle& obs : ref_obstacleVector)
-	{
-		sf::Sprite* spr = &obs.getSprite();
+		std::size_t count{ ref_spatialGrid.getCell(i).size() };
+		SpatialGrid::CircleCollider const* colliders{ ref_spatialGrid.getCellColliders(i) };
 
-		if (inCone(spr->getPosition()))
+		// nullptr if nothing occupies this cell
+		if (colliders)
 		{
-			CircleBounds c(spr->getPosition(), 35.0f);
-			m_obstaclesInCone.push_back(c);
+			m_obstacleColliders.insert(m_obstacleColliders.end(), colliders, colliders + count);
 		}
 	}
 }
@@ -553,80 +609,53 @@ void TankAi::updateGameObjects()
 
 void TankAi::muzzleFlash(sf::Vector2f t_fireDir)
 {
-	thor::FadeAnimation fade{ 0.0f,1.0f };
+	sf::Vector2f muzzle{ m_tankBase.getPosition() + t_fireDir * 60.0f };
 
-	// Muzzle Flash/Sparks effects
-	m_sparksEmitter.setParticlePosition(m_tankBase.getPosition() + t_fireDir * 60.0f);
-	m_sparksEmitter.setEmissionRate(500);
-	m_sparksEmitter.setParticleVelocity(thor::Distributions::deflect(t_fireDir * 250.0f, 10.0f));
-	m_sparksEmitter.setParticleLifetime(thor::Distributions::uniform(sf::seconds(0.1f), sf::seconds(2.0f)));
-
-	m_sparkParticleSystem.addEmitter(m_sparksEmitter, sf::seconds(0.05f));
-	m_sparkParticleSystem.addAffector(thor::AnimationAffector(fade));
+	ref_particles.burst(ParticleEffects::MUZZLE_SPARKS, muzzle, t_fireDir);
+	ref_particles.burst(ParticleEffects::MUZZLE_SMOKE, muzzle, t_fireDir);
+}
 
-	// Smoke/Dust effects
-	m_smokeEmitter.setParticlePosition(m_tankBase.getPosition() + t_fireDir * 60.0f);
-	m_smokeEmitter.setEmissionRate(500);
-	m_smokeEmitter.setParticleVelocity(thor::Distributions::deflect(t_fireDir * 60.0f, 120.0f));
-	m_smokeEmitter.setParticleLifetime(thor::Distributions::uniform(sf::seconds(0.1f), sf::seconds(1.5f)));
+////////////////////////////////////////////////////////////
 
+void TankAi::projectileImpact(sf::Vector2f t_impactPos)
+{
+	ref_events.push_back({ GameEvent::Type::ShellImpact, t_impactPos });
 
-	thor::ScaleAffector scale({ 1.1f,1.1f });
-	m_smokeParticleSystem.addEmitter(m_smokeEmitter, sf::seconds(0.1f));
-	m_smokeParticleSystem.addAffector(thor::AnimationAffector(fade));
-	m_smokeParticleSystem.addAffector(scale, sf::seconds(1));
+#ifndef HEADLESS
+	m_pendingImpactSmoke.push_back(t_impactPos);
+#endif
 }
 
 ////////////////////////////////////////////////////////////
 
-void TankAi::projectileImpact(sf::Vector2f t_impactPos)
+void TankAi::spawnPendingEffects()
 {
-	if (nullptr != m_smokeThread)
+	for (sf::Vector2f impactPos : m_pendingImpactSmoke)
 	{
-		std::cout << "Waiting for thread [" << m_smokeThread->get_id() << "] to finish... ";
-		m_smokeThread->join();
-
-		// deallocate memory occupied by old thread ptr
-		delete m_smokeThread;
+		impactSmoke(impactPos);
 	}
 
-	std::cout << "Creating thread [";
-	m_smokeThread = new std::thread(f_impactSmoke, this, t_impactPos);
-	std::cout << m_smokeThread->get_id() << "]" << std::endl;
-
-	m_impactSound.setPosition(sf::Vector3f{ t_impactPos.x, t_impactPos.y, 0.0f });
-	m_impactSound.play();
+	m_pendingImpactSmoke.clear();
 }
 
 ////////////////////////////////////////////////////////////
 
 void TankAi::impactSmoke(sf::Vector2f t_impactPos)
 {
-	std::cout << "I'm making smoke!" << std::endl;
-
-	thor::FadeAnimation fade{ 0.0f,1.0f };
-
-	// Smoke/Dust effects
-	m_impactSmokeEmitter.setParticlePosition(t_impactPos);
-	m_impactSmokeEmitter.setEmissionRate(500);
-	m_impactSmokeEmitter.setParticleVelocity(thor::Distributions::deflect({ 40.0f,40.0f }, 360.0f));
-	m_impactSmokeEmitter.setParticleLifetime(thor::Distributions::uniform(sf::seconds(0.1f), sf::seconds(0.75f)));
-
-
-	thor::ScaleAffector scale({ 1.1f,1.1f });
-	m_impactParticleSystem.addEmitter(m_impactSmokeEmitter, sf::seconds(0.25f));
-	m_impactParticleSystem.addAffector(thor::AnimationAffector(fade));
-	m_impactParticleSystem.addAffector(scale, sf::seconds(1));
+	ref_particles.burst(ParticleEffects::IMPACT_SMOKE, t_impactPos);
 }
 
 ////////////////////////////////////////////////////////////
 
 void TankAi::updateVisionCone()
 {
+	PROFILE_SCOPE("TankAi::updateVisionCone");
+
 	updateVisionColor();
 
 	// Position of our turret
 	sf::Vector2f pos{ m_turret.getPosition() };
+	m_visionOrigin = pos;
 
 	// Adjust the acuity of our ray casts
 	m_visionAcuity = std::clamp(50.0f - (m_visionDistance / 20.0f), MIN_ACUITY, MAX_ACUITY);
@@ -640,64 +669,42 @@ void TankAi::updateVisionCone()
 	// At what angle do we start drawing
 	float startAngle{ thor::toRadian(m_visionConeRotation) - m_visionArc / 2.0f };
 
-	// Initialise each ray, tracked in local coordinates (i.e., origin @ 0,0)
-	for (sf::Vector2f& ray : m_visionRayCasts)
+	m_visionRays.Reset(pos, m_visionDistance);
+
+	for (int i = 0; i < NUM_RAYS; i++)
 	{
-		ray = { m_visionDistance * cosf(startAngle), m_visionDistance * sinf(startAngle) };
+		m_visionRays.Add({ cosf(startAngle), sinf(startAngle) });
 		startAngle += m_arcPerRay;
 	}
 
-	// Should we stop our ray cast
-	bool stop{ false };
+	// Each ray ends at the first obstacle it meets
+	gatherOccluders();
+
+	for (GameObject* obstacle : m_occluders)
+	{
+		// already up to date; obstacles never move
+		CollisionDetector::rayFanBox(m_visionRays, obstacle->getBoundingBox());
+	}
 
 	// If we find the player with one raycast, do not continue to check
 	bool playerDetected{ false };
 
-	// For each ray
-	for (sf::Vector2f& ray : m_visionRayCasts)
+	for (int i = 0; i < NUM_RAYS; i++)
 	{
-		// Chose a unit to iterate along the ray by
-		sf::Vector2f unit{ thor::unitVector(ray) * (m_visionDistance / 50.0f) };
+		sf::Vector2f direction{ m_visionRays.DirX[i], m_visionRays.DirY[i] };
+		float length{ m_visionRays.Nearest[i] };
 
-		// Set start to our tank pos
-		ray = pos;
+		// Check for the player in our vision cone, short of that obstacle
+		float playerHitTime;
 
-		// For each unit along the ray
-		for (int i = 0; i < 50; i++)
+		if (!playerDetected && CollisionDetector::segmentCollision(pos, pos + direction * length, m_playerBox, playerHitTime))
 		{
-			ray += unit;
-
-			// Check for the player in our vision cone
-			if (!playerDetected)
-			{
-				if (m_playerTankRect.contains(ray))
-				{
-					playerDetected = true;
-					m_playerLastSeen.restart();
-				}
-			}
-				
-			// For each obstacle in our vision cone
-			for (CircleBounds& obstacleBounds : m_obstaclesInCone)
-			{
-				// If it contains our ray
-				if (thor::squaredLength(obstacleBounds.position - ray) < std::powf(obstacleBounds.radius,2))
-				{
-					// Break out of the loop and end the ray here
-					stop = true;
-					break;
-				}
-			}
-
-			if (stop)
-			{
-				stop = false;
-				break;
-			}
+			playerDetected = true;
+			m_playerLastSeen.restart();
 		}
 
-		// Return the ray to local bounds
-		ray -= pos;
+		// tracked in local coordinates (i.e., origin @ 0,0)
+		m_visionRayCasts[i] = direction * length;
 	}
 
 	// Set the beginning of our triangle cone
@@ -736,25 +743,13 @@ void TankAi::updateVisionColor()
 
 ////////////////////////////////////////////////////////////
 
-bool TankAi::inCone(sf::Vector2f t_pos)
+void TankAi::gatherOccluders()
 {
-	sf::Vector2f myPosition{ m_tankBase.getPosition() };
-
-	// If it's within the range of our vision cone
-	if (thor::squaredLength(t_pos - myPosition) < std::pow(m_visionDistance, 2))
-	{
-		// If it's to the left of our last ray
-		if (MathUtility::isLeft(myPosition + m_visionRayCasts[NUM_RAYS - 1], myPosition, t_pos))
-		{
-			// If it's to the right of our first ray
-			if (!MathUtility::isLeft(myPosition + m_visionRayCasts[0], myPosition, t_pos))
-			{
-				return true;
-			}
-		}
-	}
+	// every ray lies inside the cone, so anything a ray can hit overlaps it; whole cells crossed
+	// by the rays would also bring in all the rocks beside the cone
+	sf::Vector2f heading{ std::cos(thor::toRadian(m_visionConeRotation)), std::sin(thor::toRadian(m_visionConeRotation)) };
 
-	return false;
+	ref_spatialGrid.querySector(m_visionRays.Origin, heading, m_visionArc / 2.0f, m_visionRays.MaxDistance, SpatialGrid::Obstacles, m_occluders);
 }
 
 ////////////////////////////////////////////////////////////
@@ -765,4 +760,11 @@ float TankAi::calculatePitch()
 	// and determine the base angle of one given its length and arc, and double
 	// the result to get the angle of our original isosceles
 	return atanf((m_visionAcuity / 2.0f) / m_visionDistance) * 2.0f;
+}
+
+////////////////////////////////////////////////////////////
+
+sf::FloatRect TankAi::getFootprint() const
+{
+	return MathUtility::unite(m_tankBase.getGlobalBounds(), m_turret.getGlobalBounds());
 }
\ No newline at end of file
@@ -0,0 +1,169 @@
+#include "ThreadPool.h"
+
+namespace
+{
+	// which pool and queue the current thread works for, so tasks can push onto their own queue
+	thread_local ThreadPool const* currentPool{ nullptr };
+	thread_local unsigned currentQueue{ 0 };
+}
+
+////////////////////////////////////////////////////////////
+
+ThreadPool::ThreadPool(unsigned t_threadCount)
+{
+	if (0 == t_threadCount)
+	{
+		t_threadCount = std::thread::hardware_concurrency();
+	}
+
+	if (0 == t_threadCount)
+	{
+		t_threadCount = 1;
+	}
+
+	for (unsigned i = 0; i < t_threadCount; i++)
+	{
+		m_queues.push_back(std::make_unique<WorkQueue>());
+	}
+
+	for (unsigned i = 0; i < t_threadCount; i++)
+	{
+		m_threads.emplace_back(&ThreadPool::workerLoop, this, i);
+	}
+}
+
+////////////////////////////////////////////////////////////
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_stateMutex);
+		m_stopping = true;
+	}
+
+	m_workAvailable.notify_all();
+
+	for (std::thread& thread : m_threads)
+	{
+		thread.join();
+	}
+}
+
+////////////////////////////////////////////////////////////
+
+void ThreadPool::submit(std::function<void()> t_task)
+{
+	unsigned index{ (this == currentPool) ? currentQueue : static_cast<unsigned>(m_nextQueue++ % m_queues.size()) };
+
+	m_unfinished++;
+
+	{
+		std::lock_guard<std::mutex> lock(m_queues[index]->mutex);
+		m_queues[index]->tasks.push_back(std::move(t_task));
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_stateMutex);
+		m_queued++;
+	}
+
+	m_workAvailable.notify_one();
+}
+
+////////////////////////////////////////////////////////////
+
+void ThreadPool::wait()
+{
+	std::unique_lock<std::mutex> lock(m_stateMutex);
+	m_allDone.wait(lock, [this] { return 0 == m_unfinished; });
+
+	if (m_firstError)
+	{
+		std::exception_ptr error{ m_firstError };
+		m_firstError = nullptr;
+
+		std::rethrow_exception(error);
+	}
+}
+
+////////////////////////////////////////////////////////////
+
+bool ThreadPool::takeTask(unsigned t_index, std::function<void()>& t_task)
+{
+	{
+		WorkQueue& own{ *m_queues[t_index] };
+		std::lock_guard<std::mutex> lock(own.mutex);
+
+		if (!own.tasks.empty())
+		{
+			t_task = std::move(own.tasks.back());
+			own.tasks.pop_back();
+			m_queued--;
+			return true;
+		}
+	}
+
+	for (std::size_t offset = 1; offset < m_queues.size(); offset++)
+	{
+		WorkQueue& victim{ *m_queues[(t_index + offset) % m_queues.size()] };
+		std::lock_guard<std::mutex> lock(victim.mutex);
+
+		if (!victim.tasks.empty())
+		{
+			t_task = std::move(victim.tasks.front());
+			victim.tasks.pop_front();
+			m_queued--;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+////////////////////////////////////////////////////////////
+
+void ThreadPool::workerLoop(unsigned t_index)
+{
+	currentPool = this;
+	currentQueue = t_index;
+
+	std::function<void()> task;
+
+	while (true)
+	{
+		if (takeTask(t_index, task))
+		{
+			try
+			{
+				task();
+			}
+			catch (...)
+			{
+				std::lock_guard<std::mutex> lock(m_stateMutex);
+
+				if (!m_firstError)
+				{
+					m_firstError = std::current_exception();
+				}
+			}
+
+			task = nullptr;
+
+			if (0 == --m_unfinished)
+			{
+				std::lock_guard<std::mutex> lock(m_stateMutex);
+				m_allDone.notify_all();
+			}
+
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(m_stateMutex);
+		m_workAvailable.wait(lock, [this] { return m_stopping || m_queued > 0; });
+
+		if (m_stopping && 0 == m_queued)
+		{
+			return;
+		}
+	}
+}
@@ -28,14 +28,30 @@
 /// @brief starting point for all C++ programs.
 /// 
 /// Create a game object and run it.
+/// Pass --record <path> to save the player's input to a script the headless runner can replay,
+/// and --hz <rate> to change the simulation rate (60 by default) without touching the frame rate.
 /// </summary>
-/// <param name=""></param>
+/// <param name="argc"></param>
 /// <param name="argv"></param>
 /// <returns></returns>
-int main(int, char* argv[])
+int main(int argc, char* argv[])
 {
 	srand(static_cast<unsigned>(time(nullptr)));
 
-	Game game;
+	Game game(static_cast<unsigned>(rand()));
+
+	for (int i = 1; i + 1 < argc; i++)
+	{
+		if (std::string(argv[i]) == "--record")
+		{
+			game.recordInput(argv[i + 1]);
+		}
+
+		if (std::string(argv[i]) == "--hz")
+		{
+			game.setUpdateRate(static_cast<unsigned>(std::stoul(argv[i + 1])));
+		}
+	}
+
 	game.run();
 }
\ No newline at end of file